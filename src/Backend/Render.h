@@ -4,7 +4,8 @@
 //Backend render format
 struct BACKEND_RENDER_FORMAT
 {
-	PIXELFORMAT pixelFormat; //Output pixel format
+	PIXELFORMAT pixelFormat;	//Output pixel format
+	double refreshRate = 0.0;	//Refresh rate we can present at with RENDERPACING_REFRESH (0 if we can only be paced to our framerate)
 };
 
 //Render functions
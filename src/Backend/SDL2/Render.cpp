@@ -1,5 +1,6 @@
 #include "SDL_render.h"
 #include "SDL_timer.h"
+#include "SDL_version.h"
 #include "../Render.h"
 #include "../../GameConstants.h"
 
@@ -11,25 +12,56 @@ SDL_Texture *outputTexture;
 //Vsync and framerate
 long double framerateMilliseconds;
 unsigned int vsyncMultiple;
+bool vsyncEnabled;	//If our renderer's currently presenting with VSync
+bool vsyncRefresh;	//If we can present with VSync at the display's refresh rate (for RENDERPACING_REFRESH)
 
 //Buffer and render output
+bool outputLocked;
+
 bool Backend_GetOutputBuffer(void **buffer, int *pitch)
 {
-	//Lock texture
-	if (SDL_LockTexture(outputTexture, nullptr, buffer, pitch) < 0)
+	//If nothing was drawn, leave our texture with our last frame
+	if (gOutputDirty.w <= 0 || gOutputDirty.h <= 0)
+	{
+		*buffer = nullptr;
+		return false;
+	}
+	
+	//Lock the area that was drawn to (the buffer we're given starts at its top-left)
+	SDL_Rect lockRect = {gOutputDirty.x, gOutputDirty.y, gOutputDirty.w, gOutputDirty.h};
+	if (SDL_LockTexture(outputTexture, &lockRect, buffer, pitch) < 0)
 		return true;
+	
+	outputLocked = true;
 	return false;
 }
 
 bool Backend_OutputBuffer()
 {
-	//Unlock texture and draw to window
-	SDL_UnlockTexture(outputTexture);
+	//Unlock texture (if we locked it) and draw to window
+	if (outputLocked)
+		SDL_UnlockTexture(outputTexture);
+	outputLocked = false;
 	if (SDL_RenderCopy(renderer, outputTexture, nullptr, nullptr) < 0)
 		return true;
 	
+	//Only present with VSync while we're paced to the display's refresh, or if our framerate's a multiple of it
+	bool vsyncWanted = (gRenderPacing == RENDERPACING_REFRESH && vsyncRefresh) || vsyncMultiple != 0;
+	if (vsyncWanted != vsyncEnabled)
+	{
+	#if SDL_VERSION_ATLEAST(2, 0, 18)
+		if (SDL_RenderSetVSync(renderer, vsyncWanted ? 1 : 0) == 0)
+			vsyncEnabled = vsyncWanted;
+	#endif
+	}
+	
 	//Present renderer then wait for next frame (either use VSync if applicable, or just wait)
-	if (vsyncMultiple != 0)
+	if (gRenderPacing == RENDERPACING_REFRESH && vsyncEnabled)
+	{
+		//Present renderer once, VSync will wait for the display's next refresh
+		SDL_RenderPresent(renderer);
+	}
+	else if (vsyncMultiple != 0)
 	{
 		//Present renderer X amount of times, to call VSync that many times (hack-ish)
 		for (unsigned int iteration = 0; iteration < vsyncMultiple; iteration++)
@@ -82,9 +114,17 @@ bool Backend_InitRender(RENDERSPEC renderSpec, BACKEND_RENDER_FORMAT *outRenderF
 	if ((renderSpec.forceVsync && !renderSpec.forceVsyncValue) || !((renderSpec.forceVsync && renderSpec.forceVsyncValue) || (refreshIntegral >= 1.0 && refreshFractional == 0.0)))
 		vsyncMultiple = 0;
 	
+	//Check if we can present at the display's refresh rate (VSync is only turned on for it while paced to it, which needs SDL_RenderSetVSync unless we already have it)
+	vsyncRefresh = !(renderSpec.forceVsync && !renderSpec.forceVsyncValue) && mode.refresh_rate > 0;
+#if !SDL_VERSION_ATLEAST(2, 0, 18)
+	if (vsyncMultiple == 0)
+		vsyncRefresh = false;
+#endif
+	
 	//Create renderer
 	if ((renderer = SDL_CreateRenderer(window, -1, vsyncMultiple ? SDL_RENDERER_PRESENTVSYNC : 0)) == nullptr)
 		return true;
+	vsyncEnabled = (vsyncMultiple != 0);
 	
 	//Setup output render format
 	uint32_t windowFormat = SDL_GetWindowPixelFormat(window);
@@ -114,6 +154,9 @@ bool Backend_InitRender(RENDERSPEC renderSpec, BACKEND_RENDER_FORMAT *outRenderF
 		
 		//Free allocated pixel format
 		SDL_FreeFormat(winFormat);
+		
+		//Give the refresh rate we can present at with VSync
+		outRenderFormat->refreshRate = vsyncRefresh ? mode.refresh_rate : 0.0;
 	}
 	
 	//Create our output texture at the given width, height, and window format
@@ -1,10 +1,18 @@
 #include "../Render.h"
 
+//Our output buffer (rendered to, but never displayed, so rasterization can still be run and timed)
+static uint32_t *outputBuffer = nullptr;
+static int outputPitch = 0;
+
 //Buffer and render output
 bool Backend_GetOutputBuffer(void **buffer, int *pitch)
 {
-	 *buffer = nullptr;
-	 *pitch = 0;
+	//Give the area that was drawn to (nothing if it's empty)
+	if (gOutputDirty.w <= 0 || gOutputDirty.h <= 0)
+		*buffer = nullptr;
+	else
+		*buffer = (uint8_t*)outputBuffer + (gOutputDirty.y * outputPitch + gOutputDirty.x * sizeof(uint32_t));
+	*pitch = outputPitch;
 	return false;
 }
 
@@ -16,10 +24,34 @@ bool Backend_OutputBuffer()
 //Core initialization and quitting
 bool Backend_InitRender(RENDERSPEC renderSpec, BACKEND_RENDER_FORMAT *outRenderFormat)
 {
+	//Allocate our output buffer
+	outputBuffer = new uint32_t[renderSpec.width * renderSpec.height];
+	outputPitch = renderSpec.width * sizeof(uint32_t);
+	
+	//Use 32-bit ARGB
+	if (outRenderFormat != nullptr)
+	{
+		outRenderFormat->pixelFormat.bitsPerPixel =		32;
+		outRenderFormat->pixelFormat.bytesPerPixel =	4;
+		outRenderFormat->pixelFormat.rMask =			0x00FF0000;
+		outRenderFormat->pixelFormat.gMask =			0x0000FF00;
+		outRenderFormat->pixelFormat.bMask =			0x000000FF;
+		outRenderFormat->pixelFormat.aMask =			0xFF000000;
+		outRenderFormat->pixelFormat.rLoss =			0;
+		outRenderFormat->pixelFormat.gLoss =			0;
+		outRenderFormat->pixelFormat.bLoss =			0;
+		outRenderFormat->pixelFormat.aLoss =			0;
+		outRenderFormat->pixelFormat.rShift =			16;
+		outRenderFormat->pixelFormat.gShift =			8;
+		outRenderFormat->pixelFormat.bShift =			0;
+		outRenderFormat->pixelFormat.aShift =			24;
+	}
 	return false;
 }
 
 void Backend_QuitRender()
 {
-	return;
+	//Free our output buffer
+	delete[] outputBuffer;
+	outputBuffer = nullptr;
 }
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Bench.h"
+#include "Game.h"
+#include "Input.h"
+#include "Error.h"
+
+//Benchmark state
+BENCH gBench;
+
+//Default configuration
+#define BENCH_DEFAULT_FRAMES 3600
+
+//Scripted input (run right, with occasional jumps, turns, and crouches)
+static void BenchInputScript(CONTROLMASK *held, unsigned int frame)
+{
+	held->right = (frame % 400) < 300;
+	held->left = (frame % 400) >= 330 && (frame % 400) < 360;
+	held->a = (frame % 97) < 12;
+	held->down = (frame % 500) > 470;
+}
+
+//Argument parsing (--bench [level] [character set] [frames] [refresh rate])
+static bool ParseNumber(const char *string, int *out)
+{
+	//Parse the given string as a non-negative number
+	char *end;
+	long value = strtol(string, &end, 0);
+	if (*string == '\0' || *end != '\0' || value < 0)
+		return false;
+	*out = (int)value;
+	return true;
+}
+
+bool BenchParseArguments(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--bench"))
+			continue;
+		
+		//Use our defaults, then read the given arguments
+		gBench.enabled = true;
+		gBench.level = LEVELID_GHZ1;
+		gBench.characterSet = 0;
+		gBench.frames = BENCH_DEFAULT_FRAMES;
+		
+		int refreshRate = 0;
+		int *arguments[] = {&gBench.level, &gBench.characterSet, (int*)&gBench.frames, &refreshRate};
+		for (size_t v = 0; v < sizeof(arguments) / sizeof(arguments[0]) && i + 1 < argc && strncmp(argv[i + 1], "--", 2); v++)
+		{
+			if (!ParseNumber(argv[++i], arguments[v]))
+				return Error("Usage: --bench [level] [character set] [frames] [refresh rate]");
+		}
+		gBench.refreshRate = refreshRate;
+		
+		//Verify our configuration
+		if (gBench.level >= LEVELID_MAX)
+			return Error("Invalid benchmark level");
+		if (gBench.characterSet >= CHARACTERSETS)
+			return Error("Invalid benchmark character set");
+		if (gBench.frames == 0)
+			return Error("Invalid benchmark frame count");
+		
+		//Load straight into the given level with our scripted input
+		gGameLoadLevel = gBench.level;
+		gGameLoadCharacter = gBench.characterSet;
+		gInputScript = BenchInputScript;
+	}
+	
+	return false;
+}
+
+//Frame functions
+bool BenchBeginFrame()
+{
+	//Quit once all of our frames have been run
+	if (gBench.finished)
+		return true;
+	
+	//Start timing on our first frame (after the level has loaded)
+	if (!gBench.running)
+	{
+		gBench.running = true;
+		gBench.start = BENCHCLOCK::now();
+	}
+	return false;
+}
+
+void BenchEndFrame()
+{
+	//Stop timing once all of our frames have been run
+	if (gBench.running && ++gBench.frame >= gBench.frames)
+	{
+		gBench.end = BENCHCLOCK::now();
+		gBench.running = false;
+		gBench.finished = true;
+	}
+}
+
+//Report
+void BenchReport()
+{
+	static const char *phaseName[BENCHPHASE_MAX] = {
+		"UpdateStage",
+		"CheckObjectLoad",
+		"Draw",
+		"BlitQueue",
+		"Simulation",
+		"Render",
+	};
+	
+	if (!gBench.finished)
+	{
+		printf("Benchmark didn't finish (%u / %u frames)\n", gBench.frame, gBench.frames);
+		return;
+	}
+	
+	//Print our total time and framerate
+	double totalMs = std::chrono::duration<double, std::milli>(gBench.end - gBench.start).count();
+	printf("Benchmark: level %d, character set %d, %u frames in %.3f ms (%.1f fps)\n", gBench.level, gBench.characterSet, gBench.frames, totalMs, gBench.frames * 1000.0 / totalMs);
+	
+	//Print each phase's time
+	for (int i = 0; i < BENCHPHASE_MAX; i++)
+	{
+		double phaseMs = std::chrono::duration<double, std::milli>(gBench.phaseTime[i]).count();
+		printf("  %-16s %10.3f ms total %8.4f ms/frame %6.2f%%\n", phaseName[i], phaseMs, phaseMs / gBench.frames, phaseMs * 100.0 / totalMs);
+	}
+	
+	//Print our simulation time per step (steps and frames only line up if we weren't presenting at a refresh rate)
+	double simulationMs = std::chrono::duration<double, std::milli>(gBench.phaseTime[BENCHPHASE_SIMULATION]).count();
+	printf("  %u simulation steps %8.4f ms/step", gBench.steps, gBench.steps ? (simulationMs / gBench.steps) : 0.0);
+	if (gBench.refreshRate != 0.0)
+		printf(" (presenting at %.1f Hz)\n", gBench.refreshRate);
+	else
+		printf(" (one step per frame)\n");
+	
+	//Print how much of each frame was redrawn if we were tracking dirty rectangles
+	if (gBench.totalPixels != 0)
+		printf("  %.2f%% of pixels redrawn per frame (%.0f / %d)\n", gBench.dirtyPixels * 100.0 / gBench.totalPixels, (double)gBench.dirtyPixels / gBench.frames, (int)(gBench.totalPixels / gBench.frames));
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+
+//Benchmark phases
+enum BENCHPHASE
+{
+	BENCHPHASE_UPDATESTAGE,		//LEVEL::UpdateStage
+	BENCHPHASE_CHECKOBJECTLOAD,	//LEVEL::CheckObjectLoad
+	BENCHPHASE_DRAW,			//LEVEL::Draw
+	BENCHPHASE_BLITQUEUE,		//SOFTWAREBUFFER::BlitQueue
+	BENCHPHASE_SIMULATION,		//Every simulation step run for a frame
+	BENCHPHASE_RENDER,			//Drawing and presenting a frame
+	BENCHPHASE_MAX,
+};
+
+//Benchmark state
+typedef std::chrono::steady_clock BENCHCLOCK;
+
+struct BENCH
+{
+	//Configuration
+	bool enabled = false;
+	int level = 0;				//Level to load
+	int characterSet = 0;		//Character set to load with
+	unsigned int frames = 0;	//How many frames to run
+	double refreshRate = 0.0;	//Refresh rate to present at (0 to run one simulation step per frame)
+	
+	//Progress
+	unsigned int frame = 0;
+	unsigned int steps = 0;		//Simulation steps run
+	uint64_t dirtyPixels = 0;	//Pixels redrawn with dirty rectangle tracking
+	uint64_t totalPixels = 0;	//Pixels of every frame drawn with dirty rectangle tracking
+	bool running = false;
+	bool finished = false;
+	
+	//Timing
+	BENCHCLOCK::time_point start, end;
+	BENCHCLOCK::time_point phaseStart[BENCHPHASE_MAX];
+	BENCHCLOCK::duration phaseTime[BENCHPHASE_MAX] = {};
+};
+
+extern BENCH gBench;
+
+//Phase timing
+inline void BenchBeginPhase(BENCHPHASE phase)
+{
+	if (gBench.running)
+		gBench.phaseStart[phase] = BENCHCLOCK::now();
+}
+
+inline void BenchEndPhase(BENCHPHASE phase)
+{
+	if (gBench.running)
+		gBench.phaseTime[phase] += BENCHCLOCK::now() - gBench.phaseStart[phase];
+}
+
+//Dirty rectangle coverage
+inline void BenchCountPixels(uint64_t dirtyPixels, uint64_t totalPixels)
+{
+	if (gBench.running)
+	{
+		gBench.dirtyPixels += dirtyPixels;
+		gBench.totalPixels += totalPixels;
+	}
+}
+
+//Benchmark functions
+bool BenchParseArguments(int argc, char *argv[]);
+bool BenchBeginFrame();
+void BenchEndFrame();
+void BenchReport();
@@ -8,6 +8,10 @@ class CAMERA
 	public:
 		int16_t xPos;
 		int16_t yPos;
+		
+		//Our position before the last simulation step, and the position we're drawn at (interpolated between them)
+		int16_t prevXPos = 0, prevYPos = 0;
+		int16_t drawXPos = 0, drawYPos = 0;
 		int16_t xPan = 0;
 		int16_t yPan = 0;
 		int16_t lookPan = 0;
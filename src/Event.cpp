@@ -1,10 +1,15 @@
 #include "Backend/Event.h"
 #include "Input.h"
+#include "Bench.h"
 
 bool HandleEvents()
 {
 	//Handle events on the backend
 	bool exit = Backend_HandleEvents();
 	UpdateInput();
+	
+	//Quit once our benchmark is finished
+	if (gBench.enabled && BenchBeginFrame())
+		exit = true;
 	return exit;
 }
@@ -243,49 +243,53 @@ bool FadeOutToWhite(COLOUR *colour)
 }
 
 //[[Full palette operations]]
-//Fading in/out black
-bool PaletteFadeInFromBlack(PALETTE *palette)
+static bool FadePalette(PALETTE *palette, bool (*function)(COLOUR *colour))
 {
-	bool finished = true;
+	//Fade each colour, and mark the palette as changed if any native colours changed
+	bool finished = true, changed = false;
 	for (size_t i = 0; i < palette->colours; i++)
-		finished = FadeInFromBlack(&palette->colour[i]) ? finished : false;
+	{
+		const uint32_t lastColour = palette->colour[i].colour;
+		finished = function(&palette->colour[i]) ? finished : false;
+		changed = (palette->colour[i].colour != lastColour) ? true : changed;
+	}
+	
+	if (changed)
+		palette->MarkDirty();
 	return finished;
 }
 
+//Fading in/out black
+bool PaletteFadeInFromBlack(PALETTE *palette)
+{
+	return FadePalette(palette, &FadeInFromBlack);
+}
+
 bool PaletteFadeOutToBlack(PALETTE *palette)
 {
-	bool finished = true;
-	for (size_t i = 0; i < palette->colours; i++)
-		finished = FadeOutToBlack(&palette->colour[i]) ? finished : false;
-	return finished;
+	return FadePalette(palette, &FadeOutToBlack);
 }
 
 //Fading in/out white
 bool PaletteFadeInFromWhite(PALETTE *palette)
 {
-	bool finished = true;
-	for (size_t i = 0; i < palette->colours; i++)
-		finished = FadeInFromWhite(&palette->colour[i]) ? finished : false;
-	return finished;
+	return FadePalette(palette, &FadeInFromWhite);
 }
 
 bool PaletteFadeOutToWhite(PALETTE *palette)
 {
-	bool finished = true;
-	for (size_t i = 0; i < palette->colours; i++)
-		finished = FadeOutToWhite(&palette->colour[i]) ? finished : false;
-	return finished;
+	return FadePalette(palette, &FadeOutToWhite);
 }
 
 //Fill palette black / white
 void FillPaletteBlack(PALETTE *palette)
 {
 	for (size_t i = 0; i < palette->colours; i++)
-		palette->colour[i].SetColour(true, false, true, 0x00, 0x00, 0x00);
+		palette->SetColour(i, true, false, true, 0x00, 0x00, 0x00);
 }
 
 void FillPaletteWhite(PALETTE *palette)
 {
 	for (size_t i = 0; i < palette->colours; i++)
-		palette->colour[i].SetColour(true, false, true, 0xFF, 0xFF, 0xFF);
+		palette->SetColour(i, true, false, true, 0xFF, 0xFF, 0xFF);
 }
@@ -0,0 +1,80 @@
+#include "FrameArena.h"
+#include "Log.h"
+
+//Global frame arena
+FRAMEARENA *gFrameArena = nullptr;
+
+//Constructor and destructor
+FRAMEARENA::FRAMEARENA(size_t setSize)
+{
+	//Set us as the global frame arena
+	gFrameArena = this;
+	
+	//Allocate both of our buffers
+	for (int i = 0; i < 2; i++)
+		buffer[i].data = new uint8_t[buffer[i].size = setSize];
+}
+
+FRAMEARENA::~FRAMEARENA()
+{
+	LOG(("Frame arena high-water mark: %zu bytes (%zu overflow allocations)\n", highWater, overflowCount));
+	
+	//Free our buffers and any overflow allocations
+	for (int i = 0; i < 2; i++)
+	{
+		delete[] buffer[i].data;
+		while (buffer[i].overflow.head)
+		{
+			delete[] buffer[i].overflow.head->node_entry;
+			buffer[i].overflow.erase_node(buffer[i].overflow.head);
+		}
+	}
+	
+	//Unset global frame arena
+	if (gFrameArena == this)
+		gFrameArena = nullptr;
+}
+
+//Allocation functions
+void *FRAMEARENA::AllocOverflow(size_t size)
+{
+	//Allocate outside of our main memory, this'll be freed (and our main memory expanded to fit) once this buffer is reset
+	uint8_t *alloc = new uint8_t[size];
+	buffer[current].overflow.link_back(alloc);
+	buffer[current].overflowUsed += size;
+	overflowCount++;
+	return alloc;
+}
+
+//Frame function
+void FRAMEARENA::Reset()
+{
+	//Update our high-water mark
+	size_t used = GetUsed();
+	if (used > highWater)
+		highWater = used;
+	
+	//Switch to our other buffer (the buffer we were using stays intact until the next reset)
+	current ^= 1;
+	generation++;
+	
+	FRAMEARENA_BUFFER *curBuffer = &buffer[current];
+	
+	//Free overflow allocations, and expand our main memory to fit if we overflowed
+	if (curBuffer->overflow.size())
+	{
+		size_t newSize = curBuffer->used + curBuffer->overflowUsed;
+		while (curBuffer->overflow.head)
+		{
+			delete[] curBuffer->overflow.head->node_entry;
+			curBuffer->overflow.erase_node(curBuffer->overflow.head);
+		}
+		
+		delete[] curBuffer->data;
+		curBuffer->data = new uint8_t[curBuffer->size = newSize + newSize / 2];
+	}
+	
+	//Clear our buffer
+	curBuffer->used = 0;
+	curBuffer->overflowUsed = 0;
+}
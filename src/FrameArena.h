@@ -0,0 +1,72 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include "LinkedList.h"
+
+//Frame arena constants
+#define FRAMEARENA_DEFAULT_SIZE	0x40000	//Initial size of each of the arena's buffers
+#define FRAMEARENA_ALIGN		0x10	//Alignment of every allocation
+
+//Frame arena buffer (one of two, alternated between every frame)
+struct FRAMEARENA_BUFFER
+{
+	uint8_t *data = nullptr;			//Our main memory
+	size_t size = 0;					//Size of our main memory
+	size_t used = 0;					//How much of our memory has been allocated this frame
+	size_t overflowUsed = 0;			//How much memory had to be allocated outside of our main memory this frame
+	LINKEDLIST<uint8_t*> overflow;		//Allocations that didn't fit in our main memory (freed on reset)
+};
+
+//Frame arena class
+class FRAMEARENA
+{
+	public:
+		//Our two buffers, the previous frame's buffer is kept intact until the frame after, so data can be carried over
+		FRAMEARENA_BUFFER buffer[2];
+		size_t current = 0;
+		
+		//Frame generation (incremented every reset)
+		unsigned int generation = 0;
+		
+		//Statistics
+		size_t highWater = 0;			//The most memory that's been allocated in a single frame
+		size_t overflowCount = 0;		//How many allocations didn't fit in our main memory
+	
+	public:
+		//Constructor and destructor
+		FRAMEARENA(size_t setSize);
+		~FRAMEARENA();
+		
+		//Allocation functions
+		void *AllocOverflow(size_t size);
+		
+		inline void *Alloc(size_t size)
+		{
+			//Round up our size, then allocate from our current buffer if there's space
+			FRAMEARENA_BUFFER *curBuffer = &buffer[current];
+			size = (size + (FRAMEARENA_ALIGN - 1)) & ~(size_t)(FRAMEARENA_ALIGN - 1);
+			
+			if (curBuffer->used + size > curBuffer->size)
+				return AllocOverflow(size);
+			
+			void *alloc = curBuffer->data + curBuffer->used;
+			curBuffer->used += size;
+			return alloc;
+		}
+		
+		template <typename T> inline T *New()
+		{
+			//Allocate and construct a T
+			return new (Alloc(sizeof(T))) T;
+		}
+		
+		//Frame function
+		void Reset();
+		
+		//Get how much memory has been allocated this frame
+		inline size_t GetUsed() { return buffer[current].used + buffer[current].overflowUsed; }
+};
+
+//Globals
+extern FRAMEARENA *gFrameArena;
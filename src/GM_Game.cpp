@@ -7,18 +7,25 @@
 #include "Render.h"
 #include "Fade.h"
 #include "Level.h"
+#include "FrameArena.h"
+#include "Bench.h"
+#include "MathUtil.h"
+#include "StateHash.h"
+#include "Timestep.h"
 
 LEVEL *gLevel;
 
 int gGameLoadLevel = 0;
 int gGameLoadCharacter = 0;
 
+std::string gGameRecordPath;
+
 static const char *sonicOnly[] =		{"data/Sonic/Sonic", nullptr};
 static const char *sonicAndTails[] =	{"data/Sonic/Sonic", "data/Tails/Tails", nullptr};
 static const char *tailsOnly[] =		{"data/Knuckles/Knuckles", nullptr};
 static const char *knucklesOnly[] =		{"data/Knuckles/Knuckles", nullptr};
 
-static const char **characterSetList[] = {
+static const char **characterSetList[CHARACTERSETS] = {
 	sonicOnly,
 	sonicAndTails,
 	tailsOnly,
@@ -27,58 +34,144 @@ static const char **characterSetList[] = {
 
 bool GM_Game(bool *bError)
 {
+	//Create our frame arena (before the level, as loading it runs an initial update)
+	FRAMEARENA frameArena(FRAMEARENA_DEFAULT_SIZE);
+	
+	//Demos are played in the level and with the characters they were recorded with
+	if (gGameMode == GAMEMODE_DEMO)
+	{
+		if (gInputPlayback == nullptr)
+		{
+			Warn("No demo to play back");
+			gGameMode = GAMEMODE_TITLE;
+			return false;
+		}
+		
+		gGameLoadLevel = gInputPlayback->level;
+		gGameLoadCharacter = gInputPlayback->characterSet;
+	}
+	
+	//Reset our random seed if recording or playing back, so the level plays out the same both times
+	bool recording = (gGameMode == GAMEMODE_GAME && !gGameRecordPath.empty());
+	if (recording || gGameMode == GAMEMODE_DEMO)
+		SetRandomSeed(0);
+	
 	//Load level with characters given
 	gLevel = new LEVEL(gGameLoadLevel, characterSetList[gGameLoadCharacter]);
 	if (gLevel->fail != nullptr)
 		return (*bError = true);
 	
+	//Start recording our input
+	if (recording)
+		gInputRecord = new INPUTRECORDING(gGameLoadLevel, gGameLoadCharacter);
+	
 	//Fade level from black
 	gLevel->SetFade(true, false);
 	
+	//Step our simulation at a fixed rate, and present at the display's refresh rate if we can (otherwise, step once per frame)
+	double refreshRate = gBench.enabled ? gBench.refreshRate : gRefreshRate;
+	TIMESTEP timestep(gRenderSpec.framerate, refreshRate);
+	
+	if (refreshRate != 0.0)
+		gRenderPacing = RENDERPACING_REFRESH;
+	
 	//Our loop
 	bool bExit = false;
 	
 	while (!(bExit || *bError))
 	{
-		//Handle events
-		bExit = HandleEvents();
+		//Reset frame arena
+		frameArena.Reset();
 		
-		//Update level
-		if ((*bError = gLevel->Update()) == true)
-			break;
+		//Get how many steps to simulate this frame (benchmarks use exact refreshes, so they play out the same every time)
+		unsigned int steps = 1;
+		if (refreshRate != 0.0)
+			steps = gBench.enabled ? timestep.Advance(timestep.refreshTime) : timestep.Advance();
 		
-		//Handle level fading
+		//Run our simulation steps
 		bool breakThisState = false;
 		
-		if (gLevel->fading)
+		for (unsigned int step = 0; step < steps && !(bExit || breakThisState); step++)
 		{
-			if (gLevel->isFadingIn)
+			//Handle events
+			bExit = HandleEvents();
+			BenchBeginPhase(BENCHPHASE_SIMULATION);
+			
+			//Update level
+			if ((*bError = gLevel->Update()) == true)
+				break;
+			
+			//Hash our simulation state for this step
+			if (gStateHash != nullptr)
+				gStateHash->Frame(gLevel);
+			
+			//End our demo once its playback has finished (after the update, so the last recorded frame is played out like any other)
+			if (gGameMode == GAMEMODE_DEMO && gInputPlayback->IsFinished() && !gLevel->fading)
+				gLevel->SetFade(false, false);
+			
+			//Handle level fading
+			if (gLevel->fading)
 			{
-				gLevel->fading = !gLevel->UpdateFade();
-			}
-			else
-			{
-				//Fade out and enter next game state
-				if (gLevel->UpdateFade())
+				if (gLevel->isFadingIn)
+				{
+					gLevel->fading = !gLevel->UpdateFade();
+				}
+				else
 				{
-					gGameMode = gLevel->specialFade ? GAMEMODE_SPECIALSTAGE : (gGameMode == GAMEMODE_DEMO ? GAMEMODE_SPLASH : GAMEMODE_GAME);
-					breakThisState = true;
+					//Fade out and enter next game state
+					if (gLevel->UpdateFade())
+					{
+						gGameMode = gLevel->specialFade ? GAMEMODE_SPECIALSTAGE : (gGameMode == GAMEMODE_DEMO ? GAMEMODE_SPLASH : GAMEMODE_GAME);
+						breakThisState = true;
+					}
 				}
 			}
+			
+			//Update palette cycling
+			gLevel->PaletteUpdate();
+			
+			BenchEndPhase(BENCHPHASE_SIMULATION);
+			if (gBench.running)
+				gBench.steps++;
 		}
 		
-		//Draw level to the screen
-		gLevel->Draw();
+		if (*bError)
+			break;
+		
+		//Draw level to the screen (between our last two steps, unless we're stepping once per frame)
+		BenchBeginPhase(BENCHPHASE_RENDER);
+		BenchBeginPhase(BENCHPHASE_DRAW);
+		gLevel->Draw((refreshRate != 0.0) ? timestep.GetAlpha() : 0x100, steps != 0);
+		BenchEndPhase(BENCHPHASE_DRAW);
 		
 		//Render our software buffer to the screen
 		if ((*bError = gSoftwareBuffer->RenderToScreen(&gLevel->background->texture->loadedPalette->colour[0])) == true)
 			break;
+		BenchEndPhase(BENCHPHASE_RENDER);
 		
 		//Go to next state if set to break this state
 		if (breakThisState)
 			break;
 	}
 	
+	//Go back to being paced to our framerate
+	gRenderPacing = RENDERPACING_FRAMERATE;
+	
+	//Save our input recording (only the first level played is recorded, so reloading or moving on doesn't overwrite it), or finish our demo playback
+	if (gInputRecord != nullptr)
+	{
+		*bError = gInputRecord->Save(gGameRecordPath) ? true : *bError;
+		delete gInputRecord;
+		gInputRecord = nullptr;
+		gGameRecordPath.clear();
+	}
+	
+	if (gInputPlayback != nullptr && gGameMode != GAMEMODE_DEMO)
+	{
+		delete gInputPlayback;
+		gInputPlayback = nullptr;
+	}
+	
 	//Unload level and exit
 	delete gLevel;
 	return bExit;
@@ -7,9 +7,13 @@
 #include "Fade.h"
 #include "Input.h"
 #include "SpecialStage.h"
+#include "FrameArena.h"
 
 bool GM_SpecialStage(bool *bError)
 {
+	//Create our frame arena
+	FRAMEARENA frameArena(FRAMEARENA_DEFAULT_SIZE);
+	
 	//Load the special stage
 	SPECIALSTAGE stage("data/SpecialStage/Stage/1");
 	if (stage.fail != nullptr)
@@ -20,6 +24,9 @@ bool GM_SpecialStage(bool *bError)
 	
 	while (!(bExit || *bError))
 	{
+		//Reset frame arena
+		frameArena.Reset();
+		
 		//Handle events
 		bExit = HandleEvents();
 		
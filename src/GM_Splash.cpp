@@ -7,12 +7,16 @@
 #include "MathUtil.h"
 #include "Input.h"
 #include "Audio.h"
+#include "FrameArena.h"
 
 #define SPLASH_TIME 100
 #define TRANSITION_TIME 30
 
 bool GM_Splash(bool *bError)
 {
+	//Create our frame arena
+	FRAMEARENA frameArena(FRAMEARENA_DEFAULT_SIZE);
+	
 	//Load our textures
 	TEXTURE splashTexture("data/Splash.bmp");
 	if (splashTexture.fail != nullptr)
@@ -28,6 +32,9 @@ bool GM_Splash(bool *bError)
 	
 	while (!(bExit || *bError))
 	{
+		//Reset frame arena
+		frameArena.Reset();
+		
 		//Handle events
 		bExit = HandleEvents();
 		
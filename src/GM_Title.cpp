@@ -11,6 +11,7 @@
 #include "Input.h"
 #include "Audio.h"
 #include "Background.h"
+#include "FrameArena.h"
 
 //Title constants
 enum TITLE_LAYERS
@@ -98,6 +99,7 @@ void TitleBackground(BACKGROUND *background, bool doScroll, int cameraX, int cam
 		background->texture->loadedPalette->colour[0xA] = COLOUR(c9);
 		background->texture->loadedPalette->colour[0xB] = COLOUR(cA);
 		background->texture->loadedPalette->colour[0xC] = COLOUR(cB);
+		background->texture->loadedPalette->MarkDirty();
 	}
 	//Get our scroll values
 	int scrollBG1 = cameraX / 24;
@@ -139,6 +141,9 @@ void TitleBackground(BACKGROUND *background, bool doScroll, int cameraX, int cam
 //Gamemode code
 bool GM_Title(bool *bError)
 {
+	//Create our frame arena
+	FRAMEARENA frameArena(FRAMEARENA_DEFAULT_SIZE);
+	
 	//Load our title sheet and background
 	TEXTURE titleTexture("data/Title.bmp");
 	if (titleTexture.fail != nullptr)
@@ -188,6 +193,9 @@ bool GM_Title(bool *bError)
 	
 	while (!(bExit || *bError))
 	{
+		//Reset frame arena
+		frameArena.Reset();
+		
 		//Handle events
 		bExit = HandleEvents();
 		
@@ -2,6 +2,8 @@
 #include "Log.h"
 #include "Error.h"
 #include "GM.h"
+#include "Bench.h"
+#include "Input.h"
 
 //Debug bool
 bool gDebugEnabled = false;
@@ -97,6 +99,10 @@ bool EnterGameLoop()
 {
 	//Initialize game memory
 	gGameMode = GAMEMODE_SPECIALSTAGE; //Start at splash screen
+	if (gBench.enabled)
+		gGameMode = GAMEMODE_GAME; //Benchmarks start straight in their level
+	if (gInputPlayback != nullptr)
+		gGameMode = GAMEMODE_DEMO; //Replays start straight in their recording's level
 	
 	gScore = 0;
 	gNextScoreReward = SCORE_REWARD;
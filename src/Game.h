@@ -31,6 +31,10 @@ extern LEVEL *gLevel;
 extern int gGameLoadLevel;
 extern int gGameLoadCharacter;
 
+#define CHARACTERSETS 4	//Sonic, Sonic and Tails, Tails, Knuckles
+
+extern std::string gGameRecordPath;	//If set, the input of the first level played is recorded to this file
+
 //Generic game functions
 void AddToScore(unsigned int score);
 void AddToRings(unsigned int rings);
@@ -5,14 +5,26 @@
 #include "MathUtil.h"
 #include "Log.h"
 #include "Error.h"
+#include "Game.h"
 
 //Binding save constants
 #define BINDSAVE_NAME	"InputBind.ibs"	//The name of the file
 const char *bindsaveSign = "IBV01";		//The signature, change this if you change the bindings structure or the binding enums in any way
 
+//Input recording constants
+const char *recordingSign = "IRV01";	//The signature, change this if you change the recording format or the held bitmask in any way
+
 //Controller state and default bindings
 CONTROLLER gController[CONTROLLERS];
 
+//Input script and the frame it's on
+INPUTSCRIPT gInputScript = nullptr;
+static unsigned int inputScriptFrame = 0;
+
+//Input recording and playback
+INPUTRECORDING *gInputRecord = nullptr;
+INPUTRECORDING *gInputPlayback = nullptr;
+
 const BUTTONBINDS defaultBinds[CONTROLLERS] = {
 	{ //Controller 1
 		{{IBK_RETURN,	IBB_START},			{IBK_UNKNOWN,	IBB_UNKNOWN}},	//Start
@@ -127,6 +139,24 @@ void CONTROLLER::Update(size_t controllerIndex)
 	if (axisState.up)
 		held.up = true;
 	
+	//Use our input script instead if we have one
+	if (gInputScript != nullptr && controllerIndex == 0)
+	{
+		held = {};
+		gInputScript(&held, inputScriptFrame);
+	}
+	
+	//Play back or record our held buttons
+	if (gInputPlayback != nullptr && controllerIndex == 0)
+	{
+		uint8_t bits = 0;
+		gInputPlayback->Play(&bits);
+		held.SetBits(bits);
+	}
+	
+	if (gInputRecord != nullptr && controllerIndex == 0)
+		gInputRecord->Record(held.GetBits());
+	
 	//Get our pressed buttons
 	DO_PRESS_CHECK(start);
 	DO_PRESS_CHECK(a);
@@ -141,6 +171,123 @@ void CONTROLLER::Update(size_t controllerIndex)
 	lastHeld = held;
 }
 
+//Input recording class
+INPUTRECORDING::INPUTRECORDING(int setLevel, int setCharacterSet)
+{
+	//Start an empty recording
+	level = setLevel;
+	characterSet = setCharacterSet;
+}
+
+INPUTRECORDING::INPUTRECORDING(std::string path)
+{
+	LOG(("Loading input recording from %s... ", path.c_str()));
+	
+	//Open our given file
+	FS_FILE fp(path, "rb");
+	if (fp.fail)
+	{
+		Error(fail = fp.fail);
+		return;
+	}
+	
+	//Check our signature
+	char signature[0x10] = {};
+	fp.Read(signature, 1, strlen(recordingSign));
+	if (strncmp(signature, recordingSign, strlen(recordingSign)))
+	{
+		Error(fail = "Invalid input recording signature");
+		return;
+	}
+	
+	//Read our level, character set, and runs
+	level = fp.ReadU8();
+	characterSet = fp.ReadU8();
+	
+	if (level >= LEVELID_MAX)
+	{
+		Error(fail = "Invalid input recording level");
+		return;
+	}
+	if (characterSet >= CHARACTERSETS)
+	{
+		Error(fail = "Invalid input recording character set");
+		return;
+	}
+	
+	uint32_t runCount = fp.ReadLE32();
+	if (runCount > (fp.GetSize() - fp.Tell()) / 3)
+	{
+		Error(fail = "Input recording is truncated");
+		return;
+	}
+	
+	runs.resize(runCount);
+	for (uint32_t i = 0; i < runCount; i++)
+	{
+		runs[i].held = fp.ReadU8();
+		runs[i].length = fp.ReadLE16();
+	}
+	
+	LOG(("Success!\n"));
+}
+
+bool INPUTRECORDING::Save(std::string path)
+{
+	LOG(("Saving input recording to %s... ", path.c_str()));
+	
+	//Open our given file
+	FS_FILE fp(path, "wb");
+	if (fp.fail)
+		return Error(fp.fail);
+	
+	//Write our signature, level, character set, and runs
+	fp.Write(recordingSign, 1, strlen(recordingSign));
+	fp.WriteU8(level);
+	fp.WriteU8(characterSet);
+	
+	fp.WriteLE32(runs.size());
+	for (size_t i = 0; i < runs.size(); i++)
+	{
+		fp.WriteU8(runs[i].held);
+		fp.WriteLE16(runs[i].length);
+	}
+	
+	LOG(("Success!\n"));
+	return false;
+}
+
+void INPUTRECORDING::Record(const uint8_t held)
+{
+	//Extend our last run if we're still holding the same buttons, otherwise start a new run
+	if (!runs.empty() && runs.back().held == held && runs.back().length < 0xFFFF)
+		runs.back().length++;
+	else
+		runs.push_back({held, 1});
+}
+
+bool INPUTRECORDING::Play(uint8_t *held)
+{
+	//Skip empty runs, and fail once we've reached the end
+	while (playRun < runs.size() && playFrame >= runs[playRun].length)
+	{
+		playRun++;
+		playFrame = 0;
+	}
+	
+	if (playRun >= runs.size())
+		return false;
+	
+	//Get our held buttons for this frame
+	*held = runs[playRun].held;
+	if (++playFrame >= runs[playRun].length)
+	{
+		playRun++;
+		playFrame = 0;
+	}
+	return true;
+}
+
 //Accessible input functions
 void ClearControllerInput()
 {
@@ -158,6 +305,7 @@ void UpdateInput()
 	//Update each controller
 	for (size_t i = 0; i < CONTROLLERS; i++)
 		gController[i].Update(i);
+	inputScriptFrame++;
 }
 
 //Subsystem initialization and quitting
@@ -1,6 +1,8 @@
 #pragma once
 #include <stddef.h>
 #include <stdint.h>
+#include <string>
+#include <vector>
 
 //Constants
 #define CONTROLLERS	4
@@ -333,6 +335,24 @@ struct CONTROLMASK
 	bool left = false;
 	bool down = false;
 	bool up = false;
+	
+	//Bitmask conversion (for input recordings)
+	inline uint8_t GetBits() const
+	{
+		return (start << 0) | (a << 1) | (b << 2) | (c << 3) | (right << 4) | (left << 5) | (down << 6) | (up << 7);
+	}
+	
+	inline void SetBits(const uint8_t bits)
+	{
+		start = (bits & 0x01) != 0;
+		a = (bits & 0x02) != 0;
+		b = (bits & 0x04) != 0;
+		c = (bits & 0x08) != 0;
+		right = (bits & 0x10) != 0;
+		left = (bits & 0x20) != 0;
+		down = (bits & 0x40) != 0;
+		up = (bits & 0x80) != 0;
+	}
 };
 
 struct BUTTONBIND
@@ -377,9 +397,55 @@ class CONTROLLER
 		void Update(size_t controllerIndex);
 };
 
+//Input recording class (the first controller's held buttons for every frame of a level, run-length encoded)
+struct INPUTRUN
+{
+	uint8_t held;		//Held button bitmask
+	uint16_t length;	//How many frames it's held for
+};
+
+class INPUTRECORDING
+{
+	public:
+		//Failure
+		const char *fail = nullptr;
+		
+		//Level and character set this was recorded in
+		int level = 0;
+		int characterSet = 0;
+		
+		//Our runs
+		std::vector<INPUTRUN> runs;
+		
+		//Playback position
+		size_t playRun = 0;
+		uint16_t playFrame = 0;
+		
+	public:
+		//Constructors
+		INPUTRECORDING(int setLevel, int setCharacterSet); //New recording
+		INPUTRECORDING(std::string path); //Load from file
+		
+		//Save to file
+		bool Save(std::string path);
+		
+		//Recording and playback
+		void Record(const uint8_t held);
+		bool Play(uint8_t *held);
+		inline bool IsFinished() { return playRun >= runs.size(); }
+};
+
 //Controller state global
 extern CONTROLLER gController[CONTROLLERS];
 
+//Input recording and playback (if set, the first controller's held buttons are recorded to / played back from these)
+extern INPUTRECORDING *gInputRecord;
+extern INPUTRECORDING *gInputPlayback;
+
+//Input script (if set, gives the first controller's held buttons for each frame instead of the backend)
+typedef void (*INPUTSCRIPT)(CONTROLMASK *held, unsigned int frame);
+extern INPUTSCRIPT gInputScript;
+
 //Subsystem functions
 void ClearControllerInput();
 void UpdateInput();
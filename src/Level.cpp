@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include <string.h>
+#include <algorithm>
 
 #include "Filesystem.h"
 #include "Audio.h"
@@ -9,6 +10,7 @@
 #include "Fade.h"
 #include "Error.h"
 #include "Log.h"
+#include "Bench.h"
 
 //Object function lists
 #include "Objects.h"
@@ -210,17 +212,7 @@ bool LEVEL::LoadMappings(LEVELTABLE *tableEntry)
 			for (size_t i = 0; i < chunks; i++)
 			{
 				for (int v = 0; v < (8 * 8); v++)
-				{
-					uint16_t tmap = mappingFile.ReadBE16();
-					chunkMapping[i].tile[v].altLRB	= (tmap & 0x8000) != 0;
-					chunkMapping[i].tile[v].altTop	= (tmap & 0x4000) != 0;
-					chunkMapping[i].tile[v].norLRB	= (tmap & 0x2000) != 0;
-					chunkMapping[i].tile[v].norTop	= (tmap & 0x1000) != 0;
-					chunkMapping[i].tile[v].yFlip	= (tmap & 0x0800) != 0;
-					chunkMapping[i].tile[v].xFlip	= (tmap & 0x0400) != 0;
-					chunkMapping[i].tile[v].tile	= (tmap & 0x3FF);
-					chunkMapping[i].tile[v].srcChunk = i;
-				}
+					chunkMapping[i].tile[v] = mappingFile.ReadBE16();
 			}
 			break;
 		}
@@ -263,31 +255,36 @@ bool LEVEL::LoadLayout(LEVELTABLE *tableEntry)
 				layout.height = 0x10 * 8;
 			}
 			
-			//Allocate our layout
-			layout.foreground = new TILE[layout.width * layout.height];
-			if (layout.foreground == nullptr)
+			//Allocate our chunk grid
+			layout.chunkWidth = layout.width / 8;
+			layout.chunks = new uint8_t[layout.chunkWidth * (layout.height / 8)];
+			if (layout.chunks == nullptr)
 			{
 				Error(fail = "Failed to allocate layout in memory");
 				return true;
 			}
 			
-			//Read our layout file and convert to tiles
-			for (size_t cy = 0; cy < layout.height; cy += 8)
+			//Read our layout file (our tiles are the chunk mappings' tiles)
+			for (size_t cy = 0; cy < layout.height / 8; cy++)
 			{
 				//Read foreground line
-				for (size_t cx = 0; cx < layout.width; cx += 8)
+				for (size_t cx = 0; cx < layout.chunkWidth; cx++)
 				{
-					//Read our chunk index
 					uint8_t chunk = layoutFile.ReadU8();
-					
-					//Get our tiles
-					for (int tv = 0; tv < 8 * 8; tv++)
-						layout.foreground[(cy + (tv / 8)) * layout.width + (cx + (tv % 8))] = chunkMapping[chunk].tile[tv];
+					if (chunk >= chunks)
+					{
+						Error(fail = "Layout uses a chunk that isn't in the chunk mappings");
+						return true;
+					}
+					layout.chunks[cy * layout.chunkWidth + cx] = chunk;
 				}
 				
 				//Skip background line (not used)
-				layoutFile.Seek(layout.width / 8, SEEK_CUR);
+				layoutFile.Seek(layout.chunkWidth, SEEK_CUR);
 			}
+			
+			layout.tiles = chunkMapping[0].tile;
+			layout.cells = chunks * (8 * 8);
 			break;
 		case LEVELFORMAT_TILE:
 			//Get our level dimensions
@@ -304,16 +301,10 @@ bool LEVEL::LoadLayout(LEVELTABLE *tableEntry)
 			
 			//Read our layout file
 			for (size_t tv = 0; tv < layout.width * layout.height; tv++)
-			{
-				uint16_t tmap = layoutFile.ReadBE16();
-				layout.foreground[tv].altLRB	= (tmap & 0x8000) != 0;
-				layout.foreground[tv].altTop	= (tmap & 0x4000) != 0;
-				layout.foreground[tv].norLRB	= (tmap & 0x2000) != 0;
-				layout.foreground[tv].norTop	= (tmap & 0x1000) != 0;
-				layout.foreground[tv].yFlip		= (tmap & 0x0800) != 0;
-				layout.foreground[tv].xFlip		= (tmap & 0x0400) != 0;
-				layout.foreground[tv].tile		= (tmap & 0x3FF);
-			}
+				layout.foreground[tv] = layoutFile.ReadBE16();
+			
+			layout.tiles = layout.foreground;
+			layout.cells = layout.width * layout.height;
 			break;
 		default:
 			Error(fail = "Unimplemented level format");
@@ -411,10 +402,90 @@ bool LEVEL::LoadCollisionTiles(LEVELTABLE *tableEntry)
 		collisionTile[i].angle = colAngleFile.ReadU8();
 	}
 	
+	//Bake our collision tiles into our layout
+	BakeCollision();
+	
 	LOG(("Success!\n"));
 	return false;
 }
 
+void LEVEL::BakeCollision()
+{
+	//Surface 0 is used for tiles without collision
+	collisionSurface.assign(1, COLLISIONSURFACE{});
+	std::vector<uint16_t> surfaceOfTile(collisionTiles * 4, 0); //Surface of each collision tile with each flip
+	
+	collisionCell = new COLLISIONCELL[layout.cells];
+	
+	for (size_t i = 0; i < layout.cells; i++)
+	{
+		TILE tile = layout.tiles[i];
+		bool xFlip = (tile & TILE_XFLIP) != 0;
+		bool yFlip = (tile & TILE_YFLIP) != 0;
+		
+		for (int layer = 0; layer < 4; layer++)
+		{
+			collisionCell[i].surface[layer] = 0;
+			
+			//Check if this tile is solid on this layer
+			bool alt = LAYER_IS_ALT(layer);
+			TILE solidBit = LAYER_IS_LRB(layer) ? (alt ? TILE_ALT_LRB : TILE_NOR_LRB) : (alt ? TILE_ALT_TOP : TILE_NOR_TOP);
+			size_t index = tile & TILE_INDEX;
+			if (index == 0 || index >= tiles || !(tile & solidBit))
+				continue;
+			
+			size_t colTile = alt ? tileMapping[index].alternateColTile : tileMapping[index].normalColTile;
+			if (colTile == 0 || colTile >= collisionTiles)
+				continue;
+			
+			//Get our collision tile's surface with this flip, creating it if this is the first use
+			uint16_t *surfaceIndex = &surfaceOfTile[colTile * 4 + (yFlip ? 2 : 0) + (xFlip ? 1 : 0)];
+			
+			if (*surfaceIndex == 0)
+			{
+				const COLLISIONTILE *source = &collisionTile[colTile];
+				COLLISIONSURFACE surface;
+				
+				for (int v = 0; v < 0x10; v++)
+				{
+					//Reverse our height map if horizontally flipped, and invert it if vertically flipped (and the opposite for our width map)
+					surface.normal[v] = source->normal[xFlip ? (~v & 0xF) : v];
+					if (yFlip)
+						surface.normal[v] = -surface.normal[v];
+					
+					surface.rotated[v] = source->rotated[yFlip ? (~v & 0xF) : v];
+					if (xFlip)
+						surface.rotated[v] = -surface.rotated[v];
+				}
+				
+				surface.angle = source->angle;
+				if (xFlip)
+					surface.angle = -surface.angle;
+				if (yFlip)
+					surface.angle = (-(surface.angle + 0x40)) - 0x40;
+				
+				*surfaceIndex = collisionSurface.size();
+				collisionSurface.push_back(surface);
+			}
+			
+			collisionCell[i].surface[layer] = *surfaceIndex;
+		}
+	}
+}
+
+//Object load ordering
+static inline int GetObjectLoadChunk(const OBJECT_LOAD *objectLoad)
+{
+	//Object loads are loaded and unloaded by the 0x80 pixel wide chunk they're in
+	return (int16_t)(objectLoad->x.pos & 0xFF80);
+}
+
+static bool CompareObjectLoad(const OBJECT_LOAD *a, const OBJECT_LOAD *b)
+{
+	int chunkA = GetObjectLoadChunk(a), chunkB = GetObjectLoadChunk(b);
+	return chunkA < chunkB || (chunkA == chunkB && a->sequence < b->sequence);
+}
+
 bool LEVEL::LoadObjects(LEVELTABLE *tableEntry)
 {
 	LOG(("Loading objects... "));
@@ -474,7 +545,8 @@ bool LEVEL::LoadObjects(LEVELTABLE *tableEntry)
 				}
 				
 				//Create and link object load from data
-				OBJECT_LOAD *objectLoad = new OBJECT_LOAD;
+				objectLoadPool.emplace_back();
+				OBJECT_LOAD *objectLoad = &objectLoadPool.back();
 				objectLoad->function = tableEntry->objectFunctionList[id];
 				objectLoad->status = {xFlip, yFlip, releaseDestroyed, false, false};
 				objectLoad->xLong = xPos << 16;
@@ -484,61 +556,24 @@ bool LEVEL::LoadObjects(LEVELTABLE *tableEntry)
 				objectLoad->loaded = nullptr;
 				objectLoad->loadRange = false;
 				objectLoad->specificBit = false;
+				objectLoad->sequence = objectLoadSequence++;
 				
-				objectLoadList.link_back(objectLoad);
+				objectLoads.push_back(objectLoad);
 			}
 		}
 	}
 	
-	/*
-	//Open external ring file
-	char *ringPath = AllocPath(gBasePath, tableEntry->levelReferencePath, ".ring");
-	BACKEND_FILE *ringFile = OpenFile(ringPath, "rb");
-	delete[] ringPath;
+	//Sort our object loads by X, so CheckObjectLoad only has to look at the edges of the load window
+	std::sort(objectLoads.begin(), objectLoads.end(), CompareObjectLoad);
 	
-	if (ringFile == nullptr)
+	//Load our rings
+	ringManager = new RINGMANAGER(gBasePath + tableEntry->levelReferencePath + ".ring");
+	if (ringManager->fail != nullptr)
 	{
-		Error(fail = GetFileError());
+		Error(fail = ringManager->fail);
 		return true;
 	}
 	
-	//Read external ring data
-	int rings = GetFileSize(ringFile) / 4;
-	
-	for (int i = 0; i < rings; i++)
-	{
-		int16_t xPos = ReadFile_BE16(ringFile);
-		int16_t word2 = ReadFile_BE16(ringFile);
-		int16_t yPos = word2 & 0x0FFF;
-		
-		int type = (word2 & 0xF000) >> 12;
-		
-		for (int v = 0; v <= (type & 0x7); v++)
-		{
-			//Create and link object load from data
-			OBJECT_LOAD *objectLoad = new OBJECT_LOAD;
-			objectLoad->function = &ObjRing;
-			objectLoad->status = {false, false, false, false, false};
-			objectLoad->xLong = xPos << 16;
-			objectLoad->yLong = yPos << 16;
-			objectLoad->subtype = 0;
-			
-			objectLoad->loaded = nullptr;
-			objectLoad->loadRange = false;
-			objectLoad->specificBit = false;
-			
-			objectLoadList.link_back(objectLoad);
-			
-			//Offset next position
-			if (type & 0x8)
-				yPos += 0x18;
-			else
-				xPos += 0x18;
-		}
-	}
-	
-	CloseFile(ringFile);
-	*/
 	LOG(("Success!\n"));
 	return false;
 }
@@ -588,9 +623,12 @@ void LEVEL::UnloadAll()
 {
 	//Free memory
 	delete[] layout.foreground;
+	delete[] layout.chunks;
 	delete[] chunkMapping;
 	delete[] tileMapping;
 	delete[] collisionTile;
+	delete[] collisionCell;
+	collisionSurface.clear();
 	
 	//Unload textures
 	if (tileTexture != nullptr)
@@ -600,9 +638,16 @@ void LEVEL::UnloadAll()
 	
 	//Unload players, objects, and camera
 	CLEAR_INSTANCE_LINKEDLIST(playerList);
-	CLEAR_INSTANCE_LINKEDLIST(objectList);
-	CLEAR_INSTANCE_LINKEDLIST(coreObjectList);
-	CLEAR_INSTANCE_LINKEDLIST(objectLoadList);
+	CLEAR_INSTANCE_OBJECTLIST(objectList);
+	CLEAR_INSTANCE_OBJECTLIST(coreObjectList);
+	
+	objectLoadPool.clear();
+	objectLoads.clear();
+	objectLoadPending.clear();
+	objectLoadLeft = objectLoadRight = 0;
+	
+	if (ringManager != nullptr)
+		delete ringManager;
 	
 	if (camera != nullptr)
 		delete camera;
@@ -687,6 +732,14 @@ LEVEL::LEVEL(int id, const char *players[])
 	
 	for (int i = 0; *players != nullptr; i++, players++)
 	{
+		//Objects only keep contact state for so many players
+		if (i >= OBJECT_PLAYER_REFERENCES)
+		{
+			Error(fail = "Too many players");
+			UnloadAll();
+			return;
+		}
+		
 		//Create our player
 		PLAYER *newPlayer = new PLAYER(*players, follow, i);
 		if (newPlayer->fail != nullptr)
@@ -729,12 +782,14 @@ LEVEL::LEVEL(int id, const char *players[])
 	//Initialize scores
 	InitializeScores();
 	
-	//Load objects near the player
+	//Load objects and rings near the player
 	CheckObjectLoad();
+	ringManager->UpdateWindow(camera->xPos);
 	
 	//Update stage for initialization
 	ClearControllerInput();
 	UpdateStage();
+	CheckOnscreen();
 	
 	LOG(("Success!\n"));
 }
@@ -794,16 +849,16 @@ void LEVEL::DynamicEvents()
 			//Handle S-Tube force rolling
 			for (size_t i = 0; i < playerList.size(); i++)
 			{
-				//Get this player and the tile we're on
+				//Get this player and the chunk we're on
 				PLAYER *player = playerList[i];
 				if (player->x.pos < 0 || player->x.pos >= (int16_t)(gLevel->layout.width * 16) || player->y.pos < 0 || player->y.pos >= (int16_t)(gLevel->layout.height * 16))
 					continue;
-				TILE *tile = &gLevel->layout.foreground[(player->y.pos / 16) * gLevel->layout.width + (player->x.pos / 16)];;
+				uint8_t chunk = gLevel->layout.GetChunk(player->x.pos / 16, player->y.pos / 16);
 				
 				//If this is an S-tube chunk tile, roll
 				bool doRoll = false;
 				
-				switch (tile->srcChunk)
+				switch (chunk)
 				{
 					case 0x75: case 0x76: case 0x77: case 0x78:
 					case 0x79: case 0x7A: case 0x7B: case 0x7C:
@@ -954,19 +1009,41 @@ MAPPINGS *LEVEL::GetObjectMappings(std::string path)
 }
 
 //Object load functions
+void LEVEL::AddObjectLoad(OBJECT_LOAD *objectLoad)
+{
+	//Insert the object load after everything at or left of it
+	objectLoad->sequence = objectLoadSequence++;
+	
+	std::vector<OBJECT_LOAD*>::iterator it = std::upper_bound(objectLoads.begin(), objectLoads.end(), objectLoad, CompareObjectLoad);
+	objectLoads.insert(it, objectLoad);
+	
+	//Keep our load window cursors on the same object loads
+	int chunk = GetObjectLoadChunk(objectLoad);
+	if (chunk < objectLoadWindowLeft)
+	{
+		objectLoadLeft++;
+		objectLoadRight++;
+	}
+	else if (chunk <= objectLoadWindowRight)
+	{
+		objectLoadRight++;
+	}
+	
+	//Check if it should be loaded on the next check
+	objectLoadPending.push_back(objectLoad);
+}
+
 OBJECT_LOAD *LEVEL::GetObjectLoad(OBJECT *object)
 {
 	//Return the object load that holds our object or nullptr
-	for (size_t i = 0; i < objectLoadList.size(); i++)
-		if (objectLoadList[i]->loaded == object)
-			return objectLoadList[i];
-	return nullptr;
+	return object->load;
 }
 
 void LEVEL::LinkObjectLoad(OBJECT *object)
 {
 	//Define our object load struct and link it
-	OBJECT_LOAD *objectLoad = new OBJECT_LOAD;
+	objectLoadPool.emplace_back();
+	OBJECT_LOAD *objectLoad = &objectLoadPool.back();
 	objectLoad->function = object->function;
 	objectLoad->status = object->status;
 	objectLoad->xLong = object->xLong;
@@ -976,59 +1053,169 @@ void LEVEL::LinkObjectLoad(OBJECT *object)
 	objectLoad->loaded = object;
 	objectLoad->loadRange = false;
 	objectLoad->specificBit = false;
+	object->load = objectLoad;
 	
-	objectLoadList.link_back(objectLoad);
+	AddObjectLoad(objectLoad);
 }
 
 void LEVEL::ReleaseObjectLoad(OBJECT *object)
 {
-	//Remove object from object load list
-	for (size_t i = 0; i < objectLoadList.size(); i++)
-	{
-		if (objectLoadList[i]->loaded == object)
-		{
-			delete objectLoadList[i];
-			objectLoadList.erase(i--);
-		}
-	}
+	//Release our object load, so it's never loaded again (it's left in the pool and skipped over, so nothing has to move)
+	if (object->load == nullptr)
+		return;
+	
+	object->load->released = true;
+	object->load->loaded = nullptr;
+	object->load = nullptr;
 }
 
 void LEVEL::UnrefObjectLoad(OBJECT *object)
 {
-	//Remove references to object
-	for (size_t i = 0; i < objectLoadList.size(); i++)
-	{
-		if (objectLoadList[i]->loaded == object)
-			objectLoadList[i]->loaded = nullptr;
-	}
+	//Remove our object load's reference to us
+	if (object->load != nullptr)
+		object->load->loaded = nullptr;
+	object->load = nullptr;
 }
 
 void LEVEL::CheckObjectLoad()
 {
-	//Check all object loads if they should be loaded
-	for (size_t i = 0; i < objectLoadList.size(); i++)
+	//Get our load window (the chunks from just left of the camera to just right of the screen)
+	int windowLeft = (int16_t)((camera->xPos - 0x80) & 0xFF80);
+	int windowRight = windowLeft + upperRound(0x80 + gRenderSpec.width + 0x80, 0x80);
+	
+	//Move our cursors to the edges of the new load window
+	size_t left = objectLoadLeft, right = objectLoadRight;
+	while (left > 0 && GetObjectLoadChunk(objectLoads[left - 1]) >= windowLeft)
+		left--;
+	while (left < objectLoads.size() && GetObjectLoadChunk(objectLoads[left]) < windowLeft)
+		left++;
+	while (right > 0 && GetObjectLoadChunk(objectLoads[right - 1]) > windowRight)
+		right--;
+	while (right < objectLoads.size() && GetObjectLoadChunk(objectLoads[right]) <= windowRight)
+		right++;
+	
+	//Object loads that left the window are out of range
+	for (size_t i = objectLoadLeft; i < std::min(objectLoadRight, left); i++)
+		objectLoads[i]->loadRange = false;
+	for (size_t i = std::max(right, objectLoadLeft); i < objectLoadRight; i++)
+		objectLoads[i]->loadRange = false;
+	
+	//Object loads that entered the window are in range, and should be loaded if they haven't been already
+	objectLoadEntering.clear();
+	
+	for (size_t i = left; i < std::min(right, objectLoadLeft); i++)
+		CheckObjectLoadRange(objectLoads[i], true);
+	for (size_t i = std::max(objectLoadRight, left); i < right; i++)
+		CheckObjectLoadRange(objectLoads[i], true);
+	
+	//Object loads linked since the last check haven't had their range checked yet
+	for (size_t i = 0; i < objectLoadPending.size(); i++)
+	{
+		int chunk = GetObjectLoadChunk(objectLoadPending[i]);
+		CheckObjectLoadRange(objectLoadPending[i], chunk >= windowLeft && chunk <= windowRight);
+	}
+	objectLoadPending.clear();
+	
+	objectLoadLeft = left;
+	objectLoadRight = right;
+	objectLoadWindowLeft = windowLeft;
+	objectLoadWindowRight = windowRight;
+	
+	//Load our entering objects (in the order their object loads were created)
+	std::sort(objectLoadEntering.begin(), objectLoadEntering.end(), [](const OBJECT_LOAD *a, const OBJECT_LOAD *b) { return a->sequence < b->sequence; });
+	
+	for (size_t i = 0; i < objectLoadEntering.size(); i++)
 	{
-		//Check if this object load is in load range
-		uint16_t xOff = (objectLoadList[i]->x.pos & 0xFF80) - ((camera->xPos - 0x80) & 0xFF80);
-		bool isLoadRange = xOff <= upperRound(0x80 + gRenderSpec.width + 0x80, 0x80);
+		OBJECT_LOAD *objectLoad = objectLoadEntering[i];
+		OBJECT *newObject = new OBJECT(objectLoad->function);
+		newObject->status = objectLoad->status;
+		newObject->xLong = objectLoad->xLong;
+		newObject->yLong = objectLoad->yLong;
+		newObject->subtype = objectLoad->subtype;
+		newObject->load = objectLoad;
+		objectLoad->loaded = newObject;
 		
-		//Check if we're just now in range, and load object if so
-		if (isLoadRange == true && objectLoadList[i]->loadRange == false && objectLoadList[i]->loaded == nullptr)
+		gLevel->objectList.link_back(newObject);
+	}
+}
+
+void LEVEL::CheckObjectLoadRange(OBJECT_LOAD *objectLoad, bool isLoadRange)
+{
+	//Released object loads are never loaded again
+	if (objectLoad->released)
+		return;
+	
+	//Check if we're just now in range, and load object if so
+	if (isLoadRange == true && objectLoad->loadRange == false && objectLoad->loaded == nullptr)
+		objectLoadEntering.push_back(objectLoad);
+	
+	//Update the object load's state
+	objectLoad->loadRange = isLoadRange;
+}
+
+//Object grid functions
+struct OBJECTGRID_BOX
+{
+	bool set = false;
+	int left, top, right, bottom;
+	
+	inline void Unite(int setLeft, int setTop, int setRight, int setBottom)
+	{
+		//Grow to cover the given box
+		if (!set)
 		{
-			//Load the object if in-range
-			OBJECT *newObject = new OBJECT(objectLoadList[i]->function);
-			newObject->status = objectLoadList[i]->status;
-			newObject->xLong = objectLoadList[i]->xLong;
-			newObject->yLong = objectLoadList[i]->yLong;
-			newObject->subtype = objectLoadList[i]->subtype;
-			objectLoadList[i]->loaded = newObject;
-			
-			gLevel->objectList.link_back(newObject);
+			left = setLeft; top = setTop; right = setRight; bottom = setBottom;
+			set = true;
+			return;
 		}
+		left = mmin(left, setLeft);
+		top = mmin(top, setTop);
+		right = mmax(right, setRight);
+		bottom = mmax(bottom, setBottom);
+	}
+};
+
+static void GetObjectGridBoxes(OBJECT *object, OBJECTGRID_BOX *touchBox, OBJECTGRID_BOX *ringBox)
+{
+	//Cover our touch box (either way around, in case our touch size is negative)
+	int touchLeft = object->x.pos - object->touchWidth, touchRight = object->x.pos + object->touchWidth;
+	int touchTop = object->y.pos - object->touchHeight, touchBottom = object->y.pos + object->touchHeight;
+	touchBox->Unite(mmin(touchLeft, touchRight), mmin(touchTop, touchBottom), mmax(touchLeft, touchRight), mmax(touchTop, touchBottom));
+	
+	//Cover our position if we're a ring
+	if (ringBox != nullptr && object->function == ObjRing)
+		ringBox->Unite(object->x.pos, object->y.pos, object->x.pos, object->y.pos);
+	
+	//Cover our children
+	for (size_t i = 0; i < object->children.size(); i++)
+		GetObjectGridBoxes(object->children[i], touchBox, ringBox);
+}
+
+void LEVEL::BuildObjectGrids()
+{
+	//Only build our ring grid if a player can attract rings (an empty grid leaves ring attraction checking every object)
+	bool buildRingGrid = false;
+	for (size_t i = 0; i < playerList.size(); i++)
+		if (playerList[i]->barrier == BARRIER_LIGHTNING)
+			buildRingGrid = true;
+	
+	//Add every object (with its children) to our grids
+	touchGrid.Clear();
+	ringGrid.Clear();
+	
+	for (size_t i = 0; i < objectList.size(); i++)
+	{
+		OBJECTGRID_BOX touchBox, ringBox;
+		GetObjectGridBoxes(objectList[i], &touchBox, buildRingGrid ? &ringBox : nullptr);
 		
-		//Update the object load's state
-		objectLoadList[i]->loadRange = isLoadRange;
+		touchGrid.Add(i, touchBox.left, touchBox.top, touchBox.right, touchBox.bottom);
+		if (ringBox.set)
+			ringGrid.Add(i, ringBox.left, ringBox.top, ringBox.right, ringBox.bottom);
 	}
+	
+	touchGrid.Build(objectList.size());
+	if (buildRingGrid)
+		ringGrid.Build(objectList.size());
 }
 
 //Object layer function
@@ -1123,6 +1310,9 @@ void LEVEL::OscillatoryUpdate()
 //Level update and draw
 bool LEVEL::UpdateStage()
 {
+	//Build our object grids for the players to check against
+	BuildObjectGrids();
+	
 	if (updateStage)
 	{
 		//Update players and objects
@@ -1138,6 +1328,8 @@ bool LEVEL::UpdateStage()
 			}
 		}
 		
+		ringManager->Update();
+		
 		for (size_t i = 0; i < coreObjectList.size(); i++)
 		{
 			if (coreObjectList[i]->Update())
@@ -1164,8 +1356,8 @@ bool LEVEL::UpdateStage()
 	}
 	
 	//Check for object deletion
-	CHECK_LINKEDLIST_OBJECTDELETE(objectList)
-	CHECK_LINKEDLIST_OBJECTDELETE(coreObjectList)
+	objectList.delete_flagged();
+	coreObjectList.delete_flagged();
 	
 	//Update camera
 	if (camera != nullptr)
@@ -1173,10 +1365,45 @@ bool LEVEL::UpdateStage()
 	return false;
 }
 
+void LEVEL::SavePositions()
+{
+	//Remember where our camera, players, and objects were before this step, so they can be drawn between it and the next
+	if (camera != nullptr)
+	{
+		camera->prevXPos = camera->xPos;
+		camera->prevYPos = camera->yPos;
+	}
+	
+	for (size_t i = 0; i < playerList.size(); i++)
+	{
+		playerList[i]->prevXPos = playerList[i]->x.pos;
+		playerList[i]->prevYPos = playerList[i]->y.pos;
+	}
+	
+	for (size_t i = 0; i < objectList.size(); i++)
+		objectList[i]->SavePosition();
+	for (size_t i = 0; i < coreObjectList.size(); i++)
+		coreObjectList[i]->SavePosition();
+}
+
+void LEVEL::CheckOnscreen()
+{
+	//Check which players and objects are on-screen at the end of this step (the next step's objects act on this)
+	for (size_t i = 0; i < playerList.size(); i++)
+		playerList[i]->CheckOnscreen();
+	for (size_t i = 0; i < objectList.size(); i++)
+		objectList[i]->CheckOnscreen();
+	for (size_t i = 0; i < coreObjectList.size(); i++)
+		coreObjectList[i]->CheckOnscreen();
+}
+
 bool LEVEL::Update()
 {
+	//Save our positions to draw from
+	SavePositions();
+	
 	//Update title card
-	titleCard->UpdateAndDraw();
+	titleCard->Update();
 	if (titleCard->activeLock)
 		return false;
 	
@@ -1185,7 +1412,10 @@ bool LEVEL::Update()
 		return false;
 	
 	//Update the stage
-	if (UpdateStage())
+	BenchBeginPhase(BENCHPHASE_UPDATESTAGE);
+	bool error = UpdateStage();
+	BenchEndPhase(BENCHPHASE_UPDATESTAGE);
+	if (error)
 		return true;
 	frameCounter++;
 	
@@ -1194,16 +1424,22 @@ bool LEVEL::Update()
 		DynamicEvents();
 	
 	//Load objects and update oscillatory values
+	BenchBeginPhase(BENCHPHASE_CHECKOBJECTLOAD);
 	CheckObjectLoad();
+	BenchEndPhase(BENCHPHASE_CHECKOBJECTLOAD);
+	ringManager->UpdateWindow(camera->xPos);
 	OscillatoryUpdate();
 	
 	//Increase our time
 	if (gLevel->updateTime)
 		gTime++;
+	
+	//Check what's on-screen now that everything's moved
+	CheckOnscreen();
 	return false;
 }
 
-void LEVEL::Draw()
+void LEVEL::PaletteUpdate()
 {
 	//Update palette cycling
 	if (!fading)
@@ -1214,35 +1450,57 @@ void LEVEL::Draw()
 		if (paletteFunction != nullptr)
 			paletteFunction();
 	}
+}
+
+void LEVEL::Draw(uint16_t alpha, bool stepped)
+{
+	//Get where our camera's drawn (between our last two steps)
+	drawAlpha = alpha;
+	
+	if (camera != nullptr)
+	{
+		camera->drawXPos = Interpolate(camera->prevXPos, camera->xPos, alpha);
+		camera->drawYPos = Interpolate(camera->prevYPos, camera->yPos, alpha);
+	}
 	
-	//Draw and scroll background
+	//Draw background (only scrolling it if we've stepped since we were last drawn)
 	if (background != nullptr && camera != nullptr)
-		background->Draw(updateStage, camera->xPos, camera->yPos);
+		background->Draw(updateStage && stepped, camera->drawXPos, camera->drawYPos);
 	
 	//Draw foreground
-	if (layout.foreground != nullptr && tileTexture != nullptr && camera != nullptr)
+	if (layout.tiles != nullptr && tileTexture != nullptr && camera != nullptr)
 	{
-		int cLeft = mmax(camera->xPos / 16, 0);
-		int cTop = mmax(camera->yPos / 16, 0);
-		int cRight = mmin(upperRound(camera->xPos + (int)gRenderSpec.width, 16) / 16, (int)gLevel->layout.width - 1);
-		int cBottom = mmin(upperRound(camera->yPos + (int)gRenderSpec.height, 16) / 16, (int)gLevel->layout.height - 1);
+		int cLeft = mmax(camera->drawXPos / 16, 0);
+		int cTop = mmax(camera->drawYPos / 16, 0);
+		int cRight = mmin(upperRound(camera->drawXPos + (int)gRenderSpec.width, 16) / 16, (int)gLevel->layout.width - 1);
+		int cBottom = mmin(upperRound(camera->drawYPos + (int)gRenderSpec.height, 16) / 16, (int)gLevel->layout.height - 1);
 		
-		for (int ty = cTop; ty < cBottom; ty++)
+		int mapWidth = cRight - cLeft;
+		int mapHeight = cBottom - cTop;
+		
+		if (mapWidth > 0 && mapHeight > 0)
 		{
-			for (int tx = cLeft; tx < cRight; tx++)
+			//Get the visible tiles as a tilemap
+			uint16_t *map = (uint16_t*)gFrameArena->Alloc(mapWidth * mapHeight * sizeof(uint16_t));
+			uint16_t *mapCell = map;
+			
+			for (int ty = cTop; ty < cBottom; ty++)
 			{
-				//Get tile
-				TILE *tile = &layout.foreground[ty * layout.width + tx];
-				
-				if (tile->tile >= tiles || tile->tile >= tileTexture->height / 16)
-					continue;
-				
-				//Draw tile
-				RECT backSrc = {0, tile->tile * 16, 16, 16};
-				RECT frontSrc = {16, tile->tile * 16, 16, 16};
-				gSoftwareBuffer->DrawTexture(tileTexture, tileTexture->loadedPalette, &backSrc, LEVEL_RENDERLAYER_FOREGROUND_LOW, tx * 16 - camera->xPos, ty * 16 - camera->yPos, tile->xFlip, tile->yFlip);
-				gSoftwareBuffer->DrawTexture(tileTexture, tileTexture->loadedPalette, &frontSrc, LEVEL_RENDERLAYER_FOREGROUND_HIGH, tx * 16 - camera->xPos, ty * 16 - camera->yPos, tile->xFlip, tile->yFlip);
+				for (int tx = cLeft; tx < cRight; tx++)
+				{
+					//Get tile
+					TILE tile = layout.GetTile(tx, ty);
+					
+					if ((tile & TILE_INDEX) >= tiles || (tile & TILE_INDEX) >= tileTexture->height / 16)
+						*mapCell++ = TILEMAP_CELL_EMPTY;
+					else
+						*mapCell++ = (tile & TILE_INDEX) | ((tile & TILE_XFLIP) ? TILEMAP_CELL_XFLIP : 0) | ((tile & TILE_YFLIP) ? TILEMAP_CELL_YFLIP : 0);
+				}
 			}
+			
+			//Draw the low and high planes (left and right columns of the tile texture)
+			gSoftwareBuffer->DrawTilemap(tileTexture, tileTexture->loadedPalette, map, mapWidth, mapHeight,  0, LEVEL_RENDERLAYER_FOREGROUND_LOW,  cLeft * 16 - camera->drawXPos, cTop * 16 - camera->drawYPos);
+			gSoftwareBuffer->DrawTilemap(tileTexture, tileTexture->loadedPalette, map, mapWidth, mapHeight, 16, LEVEL_RENDERLAYER_FOREGROUND_HIGH, cLeft * 16 - camera->drawXPos, cTop * 16 - camera->drawYPos);
 		}
 	}
 	
@@ -1251,9 +1509,11 @@ void LEVEL::Draw()
 		playerList[i]->DrawToScreen();
 	for (size_t i = 0; i < objectList.size(); i++)
 		objectList[i]->Draw();
+	ringManager->Draw();
 	for (size_t i = 0; i < coreObjectList.size(); i++)
 		coreObjectList[i]->Draw();
 	
-	//Draw HUD
+	//Draw HUD and title card
 	hud->Draw();
+	titleCard->Draw();
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include <string>
+#include <deque>
+#include <vector>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -12,6 +14,8 @@
 #include "TitleCard.h"
 #include "Hud.h"
 #include "Background.h"
+#include "ObjectGrid.h"
+#include "RingManager.h"
 
 #define OSCILLATORY_VALUES 16
 
@@ -95,23 +99,19 @@ struct LEVELTABLE
 	uint16_t leftBoundary, rightBoundary, topBoundary, bottomBoundary;
 };
 
+//Layout tile (packed the same way as the level files)
+typedef uint16_t TILE;
+
+#define TILE_INDEX		0x03FF
+#define TILE_XFLIP		0x0400
+#define TILE_YFLIP		0x0800
+#define TILE_NOR_TOP	0x1000
+#define TILE_NOR_LRB	0x2000
+#define TILE_ALT_TOP	0x4000
+#define TILE_ALT_LRB	0x8000
+
 //Chunk mapping
-struct TILE
-{
-	//Solidity
-	bool altLRB : 1;
-	bool altTop : 1;
-	bool norLRB : 1;
-	bool norTop : 1;
-	
-	//Flipping
-	bool yFlip : 1;
-	bool xFlip : 1;
-	
-	//Tile index
-	uint16_t tile : 10;
-	uint8_t srcChunk;
-};
+#define CHUNK_TILE_SHIFT	3	//Chunks are 8x8 tiles
 
 struct CHUNKMAPPING
 {
@@ -128,9 +128,33 @@ struct TILEMAPPING
 //Layout
 struct LAYOUT
 {
+	//Size in tiles
 	size_t width = 0;
 	size_t height = 0;
+	
+	//Our tiles, indexed by cell (the chunk mappings' tiles for chunk layouts, or our own for tile layouts)
+	const TILE *tiles = nullptr;
+	size_t cells = 0;
+	
+	//Chunk layouts (a grid of chunk indices, so every use of a chunk shares its tiles)
+	uint8_t *chunks = nullptr;
+	size_t chunkWidth = 0;
+	
+	//Tile layouts (every tile stored individually)
 	TILE *foreground = nullptr;
+	
+	//Get the cell of the given tile position (which must be in the layout)
+	inline size_t GetCell(size_t tx, size_t ty) const
+	{
+		if (chunks != nullptr)
+			return ((size_t)GetChunk(tx, ty) << (CHUNK_TILE_SHIFT * 2)) | ((ty & 7) << CHUNK_TILE_SHIFT) | (tx & 7);
+		return ty * width + tx;
+	}
+	
+	inline TILE GetTile(size_t tx, size_t ty) const { return tiles[GetCell(tx, ty)]; }
+	
+	//Get the chunk at the given tile position (always 0 for tile layouts)
+	inline uint8_t GetChunk(size_t tx, size_t ty) const { return (chunks != nullptr) ? chunks[(ty >> CHUNK_TILE_SHIFT) * chunkWidth + (tx >> CHUNK_TILE_SHIFT)] : 0; }
 };
 
 //Collision tile data
@@ -144,6 +168,20 @@ struct COLLISIONTILE
 	uint8_t angle;
 };
 
+//Collision surface (a collision tile with a layout tile's flipping already applied)
+struct COLLISIONSURFACE
+{
+	int8_t normal[0x10];
+	int8_t rotated[0x10];
+	uint8_t angle;
+};
+
+//Collision cell (the collision surface of a layout tile on each collision layer, 0 if it's not solid on that layer)
+struct COLLISIONCELL
+{
+	uint16_t surface[4];
+};
+
 //Object load
 struct OBJECT_LOAD
 {
@@ -158,6 +196,10 @@ struct OBJECT_LOAD
 	OBJECT *loaded = nullptr;
 	bool loadRange = false;
 	bool specificBit = false;
+	bool released = false;	//Removed from the level, and never loaded again
+	
+	//Order we were created in (object loads entering the load window together are loaded in this order)
+	unsigned int sequence = 0;
 };
 
 //Level class
@@ -191,6 +233,9 @@ class LEVEL
 		size_t collisionTiles = 0;
 		COLLISIONTILE *collisionTile = nullptr;
 		
+		std::vector<COLLISIONSURFACE> collisionSurface;	//Baked from the layout and collision tiles (surface 0 is empty)
+		COLLISIONCELL *collisionCell = nullptr;			//One for every cell in the layout
+		
 		//Boundaries
 		uint16_t leftBoundary = 0;
 		uint16_t rightBoundary = 0;
@@ -204,9 +249,25 @@ class LEVEL
 		
 		//Players and objects
 		LINKEDLIST<PLAYER*> playerList;
-		LINKEDLIST<OBJECT*> coreObjectList;
-		LINKEDLIST<OBJECT_LOAD*> objectLoadList;
-		LINKEDLIST<OBJECT*> objectList;
+		OBJECTLIST coreObjectList;
+		OBJECTLIST objectList;
+		
+		//Object grids (rebuilt every frame, so players only have to check the objects near them)
+		OBJECTGRID touchGrid;	//Objects and their children's touch boxes
+		OBJECTGRID ringGrid;	//Rings (and objects with ring children) for ring attraction
+		
+		//Object loads (stored in a pool so they never move, and sorted by X, with cursors on the edges of the load window)
+		std::deque<OBJECT_LOAD> objectLoadPool;
+		std::vector<OBJECT_LOAD*> objectLoads;
+		std::vector<OBJECT_LOAD*> objectLoadPending;	//Object loads linked since the last check
+		std::vector<OBJECT_LOAD*> objectLoadEntering;	//Object loads that entered the load window this check
+		size_t objectLoadLeft = 0, objectLoadRight = 0;	//objectLoads[objectLoadLeft, objectLoadRight) are in the load window
+		int objectLoadWindowLeft = 0, objectLoadWindowRight = -1;	//Chunk range of the load window
+		unsigned int objectLoadSequence = 0;
+		unsigned int objectSpawnSequence = 0;	//Given to each object as it's created
+		
+		//Rings placed in the level (from the ring file, rather than as objects)
+		RINGMANAGER *ringManager = nullptr;
 		
 		//Title card, camera, and HUD
 		CAMERA *camera = nullptr;
@@ -219,6 +280,7 @@ class LEVEL
 		
 		//Other state stuff
 		int frameCounter = 0;		//Frames the level has been loaded
+		uint16_t drawAlpha = 0x100;	//How far between our last two simulation steps we're being drawn (0x100 being the latest)
 		
 		bool updateTime = true;		//If the timer should update (at the end of the level)
 		bool updateStage = true;	//If objects and other stuff should update (player not dead)
@@ -235,6 +297,7 @@ class LEVEL
 		bool LoadMappings(LEVELTABLE *tableEntry);
 		bool LoadLayout(LEVELTABLE *tableEntry);
 		bool LoadCollisionTiles(LEVELTABLE *tableEntry);
+		void BakeCollision();
 		bool LoadObjects(LEVELTABLE *tableEntry);
 		bool LoadArt(LEVELTABLE *tableEntry);
 		void UnloadAll();
@@ -251,6 +314,7 @@ class LEVEL
 		MAPPINGS *GetObjectMappings(std::string path);
 		
 		//Object load functions
+		void AddObjectLoad(OBJECT_LOAD *objectLoad);
 		OBJECT_LOAD *GetObjectLoad(OBJECT *object);
 		void LinkObjectLoad(OBJECT *object);
 		void ReleaseObjectLoad(OBJECT *object);
@@ -258,6 +322,10 @@ class LEVEL
 		
 		void CheckObjectLoad();
 		
+		//Object grid functions
+		void BuildObjectGrids();
+		void CheckObjectLoadRange(OBJECT_LOAD *objectLoad, bool isLoadRange);
+		
 		//Object layer function
 		LEVEL_RENDERLAYER GetObjectLayer(bool highPriority, int priority);
 		
@@ -269,9 +337,11 @@ class LEVEL
 		void OscillatoryUpdate();
 		
 		//Update and draw functions
+		void SavePositions();
+		void CheckOnscreen();
 		bool UpdateStage();
 		bool Update();
-		void Draw();
+		void Draw(uint16_t alpha, bool stepped);
 };
 
 extern LEVELTABLE gLevelTable[];
@@ -3,239 +3,241 @@
 #include "Game.h"
 #include "Log.h"
 
-//Get the layout tile at the given x,y coordinate
-TILE *GetTileAt(int16_t x, int16_t y)
+//Cells recently looked up by a batch, so probes landing in the same or adjacent cells don't resolve the layout again
+#define COLLISIONCACHE_SIZE 4
+
+struct COLLISIONCACHE
+{
+	int16_t cellX[COLLISIONCACHE_SIZE] = {-1, -1, -1, -1};
+	int16_t cellY[COLLISIONCACHE_SIZE] = {-1, -1, -1, -1};
+	const COLLISIONCELL *cell[COLLISIONCACHE_SIZE] = {};
+	unsigned int next = 0;
+};
+
+//Get the collision surface at the given x,y coordinate on the given layer
+static inline const COLLISIONSURFACE *GetSurfaceAt(COLLISIONCACHE &cache, int16_t x, int16_t y, COLLISIONLAYER layer)
 {
 	if (x < 0 || x >= (int16_t)(gLevel->layout.width * 16) || y < 0 || y >= (int16_t)(gLevel->layout.height * 16))
 		return nullptr;
-	return &gLevel->layout.foreground[(y / 16) * gLevel->layout.width + (x / 16)];
+	
+	//Use our cached cell if we've already looked it up, otherwise look it up from the layout and remember it
+	int16_t cellX = x / 16, cellY = y / 16;
+	const COLLISIONCELL *cell = nullptr;
+	
+	for (int i = 0; i < COLLISIONCACHE_SIZE; i++)
+	{
+		if (cache.cellX[i] == cellX && cache.cellY[i] == cellY)
+		{
+			cell = cache.cell[i];
+			break;
+		}
+	}
+	
+	if (cell == nullptr)
+	{
+		cell = &gLevel->collisionCell[gLevel->layout.GetCell(cellX, cellY)];
+		
+		unsigned int entry = cache.next++ % COLLISIONCACHE_SIZE;
+		cache.cellX[entry] = cellX;
+		cache.cellY[entry] = cellY;
+		cache.cell[entry] = cell;
+	}
+	
+	uint16_t surface = cell->surface[layer];
+	return (surface != 0) ? &gLevel->collisionSurface[surface] : nullptr;
 }
 
-#define TILE_ON_LAYER(alt, lrb, tile) (!(alt ? ((!lrb && !tile->altTop) || (lrb && !tile->altLRB)) : ((!lrb && !tile->norTop) || (lrb && !tile->norLRB))))
-
 //Horizontal collision check
-int16_t GetCollisionH_Tile2(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+static int16_t GetCollisionH_Tile2(COLLISIONCACHE &cache, int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, int16_t *angle)
 {
-	//Get our chunk tile
-	TILE *tile = GetTileAt(x, y);
+	//Get our collision surface
+	const COLLISIONSURFACE *surface = GetSurfaceAt(cache, x, y, layer);
 	
-	if (tile != nullptr && tile->tile != 0 && TILE_ON_LAYER(LAYER_IS_ALT(layer), LAYER_IS_LRB(layer), tile))
+	if (surface != nullptr)
 	{
-		TILEMAPPING *tileMap = &gLevel->tileMapping[tile->tile];
-		COLLISIONTILE *collisionTile = &gLevel->collisionTile[LAYER_IS_ALT(layer) ? (tileMap->alternateColTile) : (tileMap->normalColTile)];
+		//Get our angle
+		*angle = surface->angle;
+		
+		//Get our height in the heightmap
+		int8_t height = surface->rotated[y & 0xF];
 		
-		if (collisionTile != gLevel->collisionTile)
+		if (flipped)
+			height = -height;
+		
+		//Return surface position
+		if (height > 0)
 		{
-			//Get our angle
-			if (angle != nullptr)
-				*angle = collisionTile->angle;
-			
-			int16_t yPos = y;
-			if (tile->yFlip) //Invert if vertically flipped
-			{
-				yPos = ~yPos;
-				if (angle != nullptr)
-					*angle = (-(*angle + 0x40)) - 0x40;
-			}
-			
-			if (tile->xFlip) //Reverse if horizontally flipped
-			{
-				if (angle != nullptr)
-					*angle = -*angle;
-			}
-			
-			//Get our height in the heightmap
-			int8_t height = collisionTile->rotated[yPos & 0xF];
-			
-			if (tile->xFlip ^ flipped)
-				height = -height;
-			
-			//Return surface position
-			if (height > 0)
-			{
-				return 0xF - (height + (x & 0xF));
-			}
-			else if (height < 0)
-			{
-				int16_t distance = x & 0xF;
-				if (height + distance < 0)
-					return ~distance;
-			}
+			return 0xF - (height + (x & 0xF));
+		}
+		else if (height < 0)
+		{
+			int16_t distance = x & 0xF;
+			if (height + distance < 0)
+				return ~distance;
 		}
 	}
 	
 	return 0xF - (x & 0xF);
 }
 
-int16_t GetCollisionH(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+static int16_t GetCollisionH_Probe(COLLISIONCACHE &cache, int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, int16_t *angle)
 {
 	//Flip our x-position if flipped
 	if (flipped)
 		x ^= 0xF;
 	
-	//Get our chunk tile
-	TILE *tile = GetTileAt(x, y);
+	//Get our collision surface
+	const COLLISIONSURFACE *surface = GetSurfaceAt(cache, x, y, layer);
 	
-	if (tile != nullptr && tile->tile != 0 && TILE_ON_LAYER(LAYER_IS_ALT(layer), LAYER_IS_LRB(layer), tile))
+	if (surface != nullptr)
 	{
-		TILEMAPPING *tileMap = &gLevel->tileMapping[tile->tile];
-		COLLISIONTILE *collisionTile = &gLevel->collisionTile[LAYER_IS_ALT(layer) ? (tileMap->alternateColTile) : (tileMap->normalColTile)];
+		//Get our angle
+		*angle = surface->angle;
 		
-		if (collisionTile != gLevel->collisionTile)
+		//Get our height in the heightmap
+		int8_t height = surface->rotated[y & 0xF];
+		
+		if (flipped)
+			height = -height;
+		
+		//Either return this surface or check the tile above
+		if (height > 0)
 		{
-			//Get our angle
-			if (angle != nullptr)
-				*angle = collisionTile->angle;
-			
-			int16_t yPos = y;
-			if (tile->yFlip) //Invert if vertically flipped
-			{
-				yPos = ~yPos;
-				if (angle != nullptr)
-					*angle = (-(*angle + 0x40)) - 0x40;
-			}
-			
-			if (tile->xFlip) //Reverse if horizontally flipped
-			{
-				if (angle != nullptr)
-					*angle = -*angle;
-			}
-			
-			//Get our height in the heightmap
-			int8_t height = collisionTile->rotated[yPos & 0xF];
-			
-			if (tile->xFlip ^ flipped)
-				height = -height;
-			
-			//Either return this surface or check the tile above
-			if (height > 0)
-			{
-				if (height != 0x10)
-					return 0xF - (height + (x & 0xF));
-				else
-					return GetCollisionH_Tile2(x - (flipped ? -0x10 : 0x10), y, layer, flipped, angle) - 0x10;
-			}
-			else if (height < 0)
-			{
-				if (height + (x & 0xF) < 0)
-					return GetCollisionH_Tile2(x - (flipped ? -0x10 : 0x10), y, layer, flipped, angle) - 0x10;
-			}
+			if (height != 0x10)
+				return 0xF - (height + (x & 0xF));
+			else
+				return GetCollisionH_Tile2(cache, x - (flipped ? -0x10 : 0x10), y, layer, flipped, angle) - 0x10;
+		}
+		else if (height < 0)
+		{
+			if (height + (x & 0xF) < 0)
+				return GetCollisionH_Tile2(cache, x - (flipped ? -0x10 : 0x10), y, layer, flipped, angle) - 0x10;
 		}
 	}
 	
-	return GetCollisionH_Tile2(x + (flipped ? -0x10 : 0x10), y, layer, flipped, angle) + 0x10;
+	return GetCollisionH_Tile2(cache, x + (flipped ? -0x10 : 0x10), y, layer, flipped, angle) + 0x10;
 }
 
 //Vertical collision
-int16_t GetCollisionV_Tile2(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+static int16_t GetCollisionV_Tile2(COLLISIONCACHE &cache, int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, int16_t *angle)
 {
-	//Get our chunk tile
-	TILE *tile = GetTileAt(x, y);
+	//Get our collision surface
+	const COLLISIONSURFACE *surface = GetSurfaceAt(cache, x, y, layer);
 	
-	//Flip our y-position if flipped
-	if (tile != nullptr && tile->tile != 0 && TILE_ON_LAYER(LAYER_IS_ALT(layer), LAYER_IS_LRB(layer), tile))
+	if (surface != nullptr)
 	{
-		TILEMAPPING *tileMap = &gLevel->tileMapping[tile->tile];
-		COLLISIONTILE *collisionTile = &gLevel->collisionTile[LAYER_IS_ALT(layer) ? (tileMap->alternateColTile) : (tileMap->normalColTile)];
+		//Get our angle
+		*angle = surface->angle;
+		
+		//Get our height in the heightmap
+		int8_t height = surface->normal[x & 0xF];
 		
-		if (collisionTile != gLevel->collisionTile)
+		if (flipped)
+			height = -height;
+		
+		//Return surface position
+		if (height > 0)
 		{
-			//Get our angle
-			if (angle != nullptr)
-				*angle = collisionTile->angle;
-			
-			int16_t xPos = x;
-			if (tile->xFlip) //Reverse if horizontally flipped
-			{
-				xPos = ~xPos;
-				if (angle != nullptr)
-					*angle = -*angle;
-			}
-			
-			if (tile->yFlip) //Invert if vertically flipped
-			{
-				if (angle != nullptr)
-					*angle = (-(*angle + 0x40)) - 0x40;
-			}
-			
-			//Get our height in the heightmap
-			int8_t height = collisionTile->normal[xPos & 0xF];
-			
-			if (tile->yFlip ^ flipped)
-				height = -height;
-			
-			//Return surface position
-			if (height > 0)
-			{
-				return 0xF - (height + (y & 0xF));
-			}
-			else if (height < 0)
-			{
-				int16_t distance = y & 0xF;
-				if (height + distance < 0)
-					return ~distance;
-			}
+			return 0xF - (height + (y & 0xF));
+		}
+		else if (height < 0)
+		{
+			int16_t distance = y & 0xF;
+			if (height + distance < 0)
+				return ~distance;
 		}
 	}
 	
 	return 0xF - (y & 0xF);
 }
 
-int16_t GetCollisionV(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+static int16_t GetCollisionV_Probe(COLLISIONCACHE &cache, int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, int16_t *angle)
 {
 	//Flip our y-position if flipped
 	if (flipped)
 		y ^= 0xF;
 	
-	//Get our chunk tile
-	TILE *tile = GetTileAt(x, y);
+	//Get our collision surface
+	const COLLISIONSURFACE *surface = GetSurfaceAt(cache, x, y, layer);
 	
-	if (tile != nullptr && tile->tile != 0 && TILE_ON_LAYER(LAYER_IS_ALT(layer), LAYER_IS_LRB(layer), tile))
+	if (surface != nullptr)
 	{
-		TILEMAPPING *tileMap = &gLevel->tileMapping[tile->tile];
-		COLLISIONTILE *collisionTile = &gLevel->collisionTile[LAYER_IS_ALT(layer) ? (tileMap->alternateColTile) : (tileMap->normalColTile)];
+		//Get our angle
+		*angle = surface->angle;
+		
+		//Get our height in the heightmap
+		int8_t height = surface->normal[x & 0xF];
+		
+		if (flipped)
+			height = -height;
 		
-		if (collisionTile != gLevel->collisionTile)
+		//Either return this surface or check the tile above
+		if (height > 0)
 		{
-			//Get our angle
-			if (angle != nullptr)
-				*angle = collisionTile->angle;
-			
-			int16_t xPos = x;
-			if (tile->xFlip) //Reverse if horizontally flipped
-			{
-				xPos = ~xPos;
-				if (angle != nullptr)
-					*angle = -*angle;
-			}
-			
-			if (tile->yFlip) //Invert if vertically flipped
-			{
-				if (angle != nullptr)
-					*angle = (-(*angle + 0x40)) - 0x40;
-			}
-			
-			//Get our height in the heightmap
-			int8_t height = collisionTile->normal[xPos & 0xF];
-			
-			if (tile->yFlip ^ flipped)
-				height = -height;
-			
-			//Either return this surface or check the tile above
-			if (height > 0)
-			{
-				if (height != 0x10)
-					return 0xF - (height + (y & 0xF));
-				else
-					return GetCollisionV_Tile2(x, y - (flipped ? -0x10 : 0x10), layer, flipped, angle) - 0x10;
-			}
-			else if (height < 0)
-			{
-				if (height + (y & 0xF) < 0)
-					return GetCollisionV_Tile2(x, y - (flipped ? -0x10 : 0x10), layer, flipped, angle) - 0x10;
-			}
+			if (height != 0x10)
+				return 0xF - (height + (y & 0xF));
+			else
+				return GetCollisionV_Tile2(cache, x, y - (flipped ? -0x10 : 0x10), layer, flipped, angle) - 0x10;
+		}
+		else if (height < 0)
+		{
+			if (height + (y & 0xF) < 0)
+				return GetCollisionV_Tile2(cache, x, y - (flipped ? -0x10 : 0x10), layer, flipped, angle) - 0x10;
 		}
 	}
 	
-	return GetCollisionV_Tile2(x, y + (flipped ? -0x10 : 0x10), layer, flipped, angle) + 0x10;
+	return GetCollisionV_Tile2(cache, x, y + (flipped ? -0x10 : 0x10), layer, flipped, angle) + 0x10;
+}
+
+//Batched collision (each probe function gives -1 as the angle if there was no surface)
+void GetCollisionBatch(COLLISIONPROBE *probe, size_t probes)
+{
+	COLLISIONCACHE cache;
+	
+	for (size_t i = 0; i < probes; i++)
+	{
+		COLLISIONPROBE *thisProbe = &probe[i];
+		int16_t angle = -1;
+		
+		switch (thisProbe->direction)
+		{
+			case COLLISIONDIRECTION_DOWN:
+				thisProbe->distance = GetCollisionV_Probe(cache, thisProbe->x, thisProbe->y, thisProbe->layer, false, &angle);
+				break;
+			case COLLISIONDIRECTION_UP:
+				thisProbe->distance = GetCollisionV_Probe(cache, thisProbe->x, thisProbe->y, thisProbe->layer, true, &angle);
+				break;
+			case COLLISIONDIRECTION_LEFT:
+				thisProbe->distance = GetCollisionH_Probe(cache, thisProbe->x, thisProbe->y, thisProbe->layer, true, &angle);
+				break;
+			case COLLISIONDIRECTION_RIGHT:
+				thisProbe->distance = GetCollisionH_Probe(cache, thisProbe->x, thisProbe->y, thisProbe->layer, false, &angle);
+				break;
+		}
+		
+		//Only give our angle if we found a surface
+		if ((thisProbe->found = (angle >= 0)))
+			thisProbe->angle = (uint8_t)angle;
+	}
+}
+
+//Single probe collision
+int16_t GetCollisionH(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+{
+	COLLISIONCACHE cache;
+	int16_t foundAngle = -1;
+	int16_t distance = GetCollisionH_Probe(cache, x, y, layer, flipped, &foundAngle);
+	if (angle != nullptr && foundAngle >= 0)
+		*angle = (uint8_t)foundAngle;
+	return distance;
+}
+
+int16_t GetCollisionV(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle)
+{
+	COLLISIONCACHE cache;
+	int16_t foundAngle = -1;
+	int16_t distance = GetCollisionV_Probe(cache, x, y, layer, flipped, &foundAngle);
+	if (angle != nullptr && foundAngle >= 0)
+		*angle = (uint8_t)foundAngle;
+	return distance;
 }
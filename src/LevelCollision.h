@@ -1,4 +1,5 @@
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 
 enum COLLISIONLAYER
@@ -12,5 +13,30 @@ enum COLLISIONLAYER
 #define LAYER_IS_ALT(layer)	(layer == COLLISIONLAYER_ALTERNATE_TOP || layer == COLLISIONLAYER_ALTERNATE_LRB)
 #define LAYER_IS_LRB(layer)	(layer == COLLISIONLAYER_NORMAL_LRB || layer == COLLISIONLAYER_ALTERNATE_LRB)
 
+enum COLLISIONDIRECTION
+{
+	COLLISIONDIRECTION_DOWN,	//Vertical
+	COLLISIONDIRECTION_UP,		//Vertical, flipped
+	COLLISIONDIRECTION_LEFT,	//Horizontal, flipped
+	COLLISIONDIRECTION_RIGHT,	//Horizontal
+};
+
+//A single sensor probe for GetCollisionBatch
+struct COLLISIONPROBE
+{
+	//Where and how to probe
+	int16_t x, y;
+	COLLISIONDIRECTION direction;
+	COLLISIONLAYER layer;
+	
+	//Angle of the surface found (left untouched if there's no surface), if we found one, and the distance to it
+	uint8_t angle;
+	bool found = false;
+	int16_t distance = 0;
+	
+	COLLISIONPROBE(int16_t probeX, int16_t probeY, COLLISIONDIRECTION probeDirection, COLLISIONLAYER probeLayer, uint8_t inAngle) : x(probeX), y(probeY), direction(probeDirection), layer(probeLayer), angle(inAngle) { return; }
+};
+
+void GetCollisionBatch(COLLISIONPROBE *probe, size_t probes);
 int16_t GetCollisionH(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle);
 int16_t GetCollisionV(int16_t x, int16_t y, COLLISIONLAYER layer, bool flipped, uint8_t *angle);
@@ -22,6 +22,9 @@ void EHZ_PaletteCycle()
 		gLevel->background->texture->loadedPalette->colour[0x14] = gLevel->tileTexture->loadedPalette->colour[0x14];
 		gLevel->background->texture->loadedPalette->colour[0x1E] = gLevel->tileTexture->loadedPalette->colour[0x1E];
 		gLevel->background->texture->loadedPalette->colour[0x1F] = gLevel->tileTexture->loadedPalette->colour[0x1F];
+		
+		gLevel->tileTexture->loadedPalette->MarkDirty();
+		gLevel->background->texture->loadedPalette->MarkDirty();
 	}
 }
 
@@ -22,6 +22,9 @@ void GHZ_PaletteCycle()
 		gLevel->background->texture->loadedPalette->colour[0x29] = gLevel->tileTexture->loadedPalette->colour[0x29];
 		gLevel->background->texture->loadedPalette->colour[0x2A] = gLevel->tileTexture->loadedPalette->colour[0x2A];
 		gLevel->background->texture->loadedPalette->colour[0x2B] = gLevel->tileTexture->loadedPalette->colour[0x2B];
+		
+		gLevel->tileTexture->loadedPalette->MarkDirty();
+		gLevel->background->texture->loadedPalette->MarkDirty();
 	}
 }
 
@@ -1,3 +1,4 @@
+#include <string.h>
 #include "Log.h"
 #include "Filesystem.h"
 #include "Render.h"
@@ -5,6 +6,8 @@
 #include "Input.h"
 #include "Error.h"
 #include "Game.h"
+#include "Bench.h"
+#include "StateHash.h"
 
 //Include backend cores
 #include "Backend/Core.h"
@@ -17,21 +20,76 @@
 	#include <switch.h>
 #endif
 
-int main(int argc, char *argv[])
+//Argument parsing
+static bool ParseArguments(int argc, char *argv[])
 {
-	(void)argc; (void)argv;
+	for (int i = 1; i < argc; i++)
+	{
+		if (!strcmp(argv[i], "--record") && i + 1 < argc)
+		{
+			//Record the input of each level played
+			gGameRecordPath = argv[++i];
+		}
+		else if (!strcmp(argv[i], "--replay") && i + 1 < argc)
+		{
+			//Play back the given input recording
+			delete gInputPlayback;
+			gInputPlayback = new INPUTRECORDING(std::string(argv[++i]));
+			if (gInputPlayback->fail)
+				return true;
+		}
+		else if ((!strcmp(argv[i], "--hash-write") || !strcmp(argv[i], "--hash-check")) && i + 1 < argc)
+		{
+			//Write the simulation state of every frame to the given trace, or check it against it
+			bool checking = !strcmp(argv[i], "--hash-check");
+			delete gStateHash;
+			gStateHash = new STATEHASH(std::string(argv[++i]), checking);
+			if (gStateHash->fail)
+				return true;
+		}
+		else if (!strcmp(argv[i], "--dirty-rects"))
+		{
+			//Only redraw and output what's changed each frame
+			gRenderSpec.dirtyRects = true;
+		}
+	}
 	
+	return false;
+}
+
+int main(int argc, char *argv[])
+{
 	#ifdef ENABLE_NXLINK
 		//Enable NXLink for Switch debugging
 		socketInitializeDefault();
 		nxlinkStdio();
 	#endif
 	
+	//Handle our arguments
+	if (ParseArguments(argc, argv))
+		return -1;
+	
+	#ifdef BACKEND_VOID
+		if (BenchParseArguments(argc, argv))
+			return -1;
+	#endif
+	
 	//Initialize game sub-systems and backend core, then enter game loop
 	bool error = false;
 	if ((error = (Backend_InitCore() || InitializePath() || InitializeRender() || InitializeAudio() || InitializeInput())) == false)
 		error = EnterGameLoop();
 	
+	//Report our benchmark results
+	if (gBench.enabled)
+		BenchReport();
+	
+	//Report our state hash results
+	if (gStateHash != nullptr)
+	{
+		gStateHash->Report();
+		delete gStateHash;
+	}
+	
 	//End game sub-systems and backend core
 	QuitInput();
 	QuitAudio();
@@ -108,28 +108,37 @@ uint8_t GetAtan(int16_t x, int16_t y)
 	return angle;
 }
 
-uint32_t RandomNumber()
+//Random number generator
+struct M68KREG
 {
-	struct M68KREG
+	union
 	{
-		union
+		struct
 		{
-			struct
-			{
-				#if ENDIAN == BIG
-					//Big endian - high word first, low word second
-					uint16_t high;
-					uint16_t low;
-				#else
-					//Little endian - low word first, high word second
-					uint16_t low;
-					uint16_t high;
-				#endif
-			} w;
-			uint32_t l = 0x00000000;
-		};
-	} static seed;
-	
+			#if ENDIAN == BIG
+				//Big endian - high word first, low word second
+				uint16_t high;
+				uint16_t low;
+			#else
+				//Little endian - low word first, high word second
+				uint16_t low;
+				uint16_t high;
+			#endif
+		} w;
+		uint32_t l = 0x00000000;
+	};
+};
+
+static M68KREG seed;
+
+void SetRandomSeed(uint32_t setSeed)
+{
+	//Set our seed (0 uses the default seed)
+	seed.l = setSeed;
+}
+
+uint32_t RandomNumber()
+{
 	//Re-seed if 0
 	if (seed.l == 0)
 		seed.l = 0x2A6D365A;
@@ -8,7 +8,19 @@
 #define upperRound(x, inc)	((((x) + inc - 1) / inc) * inc)
 #define lowerRound(x, inc)	(((x) / inc) * inc)
 
+//Interpolation (alpha goes from 0 to 0x100, positions further apart than this are treated as teleports and not interpolated)
+#define INTERPOLATE_MAX_DISTANCE 0x40
+
+inline int16_t Interpolate(int16_t from, int16_t to, uint16_t alpha)
+{
+	int difference = to - from;
+	if (mabs(difference) > INTERPOLATE_MAX_DISTANCE)
+		return to;
+	return from + difference * alpha / 0x100;
+}
+
 int16_t GetSin(uint8_t angle);
 int16_t GetCos(uint8_t angle);
 uint8_t GetAtan(int16_t x, int16_t y);
+void SetRandomSeed(uint32_t setSeed);
 uint32_t RandomNumber();
@@ -19,8 +19,118 @@
 //#define SONIC12_SOLIDOBJECT_VERTICAL          //In Sonic 3, the Solid Object routine was adjusted to prefer vertical collision
 //#define SONIC12_SOLIDOBJECT_BOTTOM_INERTIA    //In Sonic 3, touching the bottom of an object clears your inertia
 
+//Object scratch pool
+OBJECTSCRATCHPOOL gObjectScratchPool;
+
+OBJECTSCRATCHPOOL::~OBJECTSCRATCHPOOL()
+{
+	//Free our chunks
+	for (size_t i = 0; i < chunks.size(); i++)
+		delete[] chunks[i];
+}
+
+void *OBJECTSCRATCHPOOL::Allocate()
+{
+	//Allocate a new chunk if we're out of free blocks
+	if (freeBlocks.empty())
+	{
+		unsigned char *chunk = new unsigned char[OBJECTSCRATCHPOOL_CHUNK_BLOCKS * OBJECT_SCRATCH_OVERFLOW_SIZE];
+		for (int i = OBJECTSCRATCHPOOL_CHUNK_BLOCKS - 1; i >= 0; i--)
+			freeBlocks.push_back(chunk + i * OBJECT_SCRATCH_OVERFLOW_SIZE);
+		chunks.push_back(chunk);
+	}
+	
+	//Take a free block
+	void *block = freeBlocks.back();
+	freeBlocks.pop_back();
+	return block;
+}
+
+//Object pool
+OBJECTPOOL gObjectPool;
+
+OBJECTPOOL::~OBJECTPOOL()
+{
+	//Free our chunks
+	for (size_t i = 0; i < chunks.size(); i++)
+		delete[] chunks[i];
+}
+
+void *OBJECTPOOL::Allocate()
+{
+	//Allocate a new chunk if we're out of free slots (lowest slots are used first)
+	if (freeSlots.empty())
+	{
+		SLOT *chunk = new SLOT[OBJECTPOOL_CHUNK_SLOTS];
+		uint32_t base = chunks.size() * OBJECTPOOL_CHUNK_SLOTS;
+		for (uint32_t i = 0; i < OBJECTPOOL_CHUNK_SLOTS; i++)
+		{
+			chunk[i].index = base + i;
+			freeSlots.push_back(base + (OBJECTPOOL_CHUNK_SLOTS - 1 - i));
+		}
+		chunks.push_back(chunk);
+	}
+	
+	//Take a free slot
+	uint32_t index = freeSlots.back();
+	freeSlots.pop_back();
+	
+	SLOT *slot = &chunks[index / OBJECTPOOL_CHUNK_SLOTS][index % OBJECTPOOL_CHUNK_SLOTS];
+	slot->alive = true;
+	return slot->object;
+}
+
+void OBJECTPOOL::Free(void *object)
+{
+	//Invalidate the slot's handles and free it
+	SLOT *slot = (SLOT*)object;
+	slot->alive = false;
+	if (++slot->generation == 0)
+		slot->generation = 1;
+	freeSlots.push_back(slot->index);
+}
+
+void OBJECTPOOL::DestroyQueued()
+{
+	//Destroy our queued objects, freeing their slots for the next objects to be created
+	for (size_t i = 0; i < destroyQueue.size(); i++)
+		delete destroyQueue[i];
+	destroyQueue.clear();
+}
+
+//Object list
+void OBJECTLIST::delete_flagged()
+{
+	//Compact the objects we're keeping in a single pass, and queue the rest to be destroyed
+	size_t keep = 0;
+	for (size_t i = 0; i < handles.size(); i++)
+	{
+		OBJECT *object = handles[i].Get();
+		if (object->deleteFlag)
+			gObjectPool.QueueDestroy(object);
+		else
+			handles[keep++] = handles[i];
+	}
+	handles.resize(keep);
+	
+	//Destroy them
+	gObjectPool.DestroyQueued();
+}
+
 //Object class
-OBJECT::OBJECT(OBJECTFUNCTION objectFunction) : function(objectFunction) { return; }
+OBJECT::OBJECT(OBJECTFUNCTION objectFunction) : function(objectFunction), spawnSequence(gLevel->objectSpawnSequence++) { return; }
+
+void *OBJECT::operator new(size_t size)
+{
+	(void)size;
+	return gObjectPool.Allocate();
+}
+
+void OBJECT::operator delete(void *pointer)
+{
+	if (pointer != nullptr)
+		gObjectPool.Free(pointer);
+}
 
 OBJECT::~OBJECT()
 {
@@ -35,12 +145,11 @@ OBJECT::~OBJECT()
 	//Remove object load references to us
 	gLevel->UnrefObjectLoad(this);
 	
-	//Free allocated scratch memory
-	free(scratch);
+	//Destroy our scratch
+	FreeScratch();
 	
-	//Destroy draw instances and children
-	CLEAR_INSTANCE_LINKEDLIST(drawInstances);
-	CLEAR_INSTANCE_LINKEDLIST(children);
+	//Destroy children (our draw instances are freed with the frame arena)
+	CLEAR_INSTANCE_OBJECTLIST(children);
 }
 
 //Generic object functions
@@ -170,49 +279,119 @@ void OBJECT::Animate_S1(const uint8_t **animationList)
 
 int16_t OBJECT::CheckCollisionDown_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionV(xPos, yPos, layer, false, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x00 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_DOWN, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x00 : probe.angle;
+	return probe.distance;
 }
 
 int16_t OBJECT::CheckCollisionUp_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionV(xPos, yPos, layer, true, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x80 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_UP, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x80 : probe.angle;
+	return probe.distance;
 }
 
 int16_t OBJECT::CheckCollisionLeft_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionH(xPos, yPos, layer, true, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x40 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_LEFT, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x40 : probe.angle;
+	return probe.distance;
 }
 
 int16_t OBJECT::CheckCollisionRight_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionH(xPos, yPos, layer, false, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0xC0 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_RIGHT, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0xC0 : probe.angle;
+	return probe.distance;
+}
+
+void OBJECT::CarryDrawInstances()
+{
+	//Check if our draw instances were allocated in a previous frame (if we haven't been updated since)
+	if (drawInstancesGeneration == gFrameArena->generation)
+		return;
+	drawInstancesGeneration = gFrameArena->generation;
+	
+	//Copy them into this frame's memory, as their memory will be gone after the next reset
+	OBJECT_DRAWINSTANCE *oldInstances = drawInstances;
+	drawInstances = nullptr;
+	drawInstanceCapacity = drawInstanceCount;
+	
+	if (drawInstanceCount != 0)
+	{
+		drawInstances = (OBJECT_DRAWINSTANCE*)gFrameArena->Alloc(drawInstanceCount * sizeof(OBJECT_DRAWINSTANCE));
+		memcpy(drawInstances, oldInstances, drawInstanceCount * sizeof(OBJECT_DRAWINSTANCE));
+	}
 }
 
 void OBJECT::DrawInstance(OBJECT_RENDERFLAGS iRenderFlags, TEXTURE *iTexture, OBJECT_MAPPING iMapping, bool iHighPriority, uint8_t iPriority, uint16_t iMappingFrame, int16_t iXPos, int16_t iYPos)
 {
+	//Make sure our current draw instances are in this frame's memory
+	CarryDrawInstances();
+	
+	//If our array is full, move it into a bigger one
+	if (drawInstanceCount == drawInstanceCapacity)
+	{
+		drawInstanceCapacity = drawInstanceCapacity ? (drawInstanceCapacity * 2) : OBJECT_DRAWINSTANCE_CAPACITY;
+		OBJECT_DRAWINSTANCE *newInstances = (OBJECT_DRAWINSTANCE*)gFrameArena->Alloc(drawInstanceCapacity * sizeof(OBJECT_DRAWINSTANCE));
+		if (drawInstanceCount != 0)
+			memcpy(newInstances, drawInstances, drawInstanceCount * sizeof(OBJECT_DRAWINSTANCE));
+		drawInstances = newInstances;
+	}
+	
 	//Create a draw instance with the properties given
-	OBJECT_DRAWINSTANCE *newInstance = new OBJECT_DRAWINSTANCE;
-	newInstance->renderFlags = iRenderFlags;
+	OBJECT_DRAWINSTANCE *newInstance = &drawInstances[drawInstanceCount++];
 	newInstance->texture = iTexture;
-	newInstance->mapping = iMapping;
-	newInstance->highPriority = iHighPriority;
-	newInstance->priority = iPriority;
-	newInstance->mappingFrame = iMappingFrame;
 	newInstance->xPos = iXPos;
 	newInstance->yPos = iYPos;
-	drawInstances.link_back(newInstance);
+	newInstance->priority = iPriority;
+	newInstance->xFlip = iRenderFlags.xFlip;
+	newInstance->yFlip = iRenderFlags.yFlip;
+	newInstance->alignPlane = iRenderFlags.alignPlane;
+	newInstance->highPriority = iHighPriority;
+	
+	//Get our source rect and origin now, so drawing doesn't have to look at our mappings
+	RECT mapRect;
+	POINT mapOrig;
+	
+	if (!iRenderFlags.staticMapping)
+	{
+		//Don't draw anything if out of bounds or no mappings are defined
+		if (iMapping.mappings == nullptr || iMappingFrame >= iMapping.mappings->size)
+		{
+			newInstance->texture = nullptr;
+			return;
+		}
+		
+		//Pull rect and origin from mappings list using mappingFrame
+		mapRect = iMapping.mappings->rect[iMappingFrame];
+		mapOrig = iMapping.mappings->origin[iMappingFrame];
+	}
+	else
+	{
+		//Just use our static rect and origin
+		mapRect = iMapping.rect;
+		mapOrig = iMapping.origin;
+	}
+	
+	newInstance->srcX = mapRect.x;
+	newInstance->srcY = mapRect.y;
+	newInstance->srcW = mapRect.w;
+	newInstance->srcH = mapRect.h;
+	newInstance->origX = iRenderFlags.xFlip ? (mapRect.w - mapOrig.x) : mapOrig.x;
+	newInstance->origY = iRenderFlags.yFlip ? (mapRect.h - mapOrig.y) : mapOrig.y;
 }
 
 void OBJECT::UnloadOffscreen(int16_t xPos)
@@ -871,16 +1050,16 @@ bool OBJECT::Update()
 	//If our function has changed, free any allocated scratch memory
 	if (function != prevFunction)
 	{
-		//Free all scratch memory
-		free(scratch);
-		scratch =  nullptr;
+		//Destroy our scratch
+		FreeScratch();
 		
 		//Remember this as our last function
 		prevFunction = function;
 	}
 	
-	//Destroy draw instances from last update
-	CLEAR_INSTANCE_LINKEDLIST(drawInstances);
+	//Clear draw instances from last update
+	drawInstances = nullptr;
+	drawInstanceCount = drawInstanceCapacity = 0;
 	
 	//Run our object code
 	if (function != nullptr)
@@ -908,32 +1087,62 @@ bool OBJECT::Update()
 		for (size_t i = 0; i < children.size(); i++)
 			if (children[i]->Update())
 				return true;
-		CHECK_LINKEDLIST_OBJECTDELETE(children);
+		children.delete_flagged();
 	}
 	
 	return false;
 }
 
-void OBJECT::Draw()
+void OBJECT::SavePosition()
+{
+	//Remember our position before this step, so we can be drawn between it and where we end up
+	prevXPos = x.pos;
+	prevYPos = y.pos;
+	interpolate = true;
+	
+	for (size_t i = 0; i < children.size(); i++)
+		children[i]->SavePosition();
+}
+
+void OBJECT::CheckOnscreen()
 {
-	if (drawInstances.size() > 0)
+	//Make sure our draw instances are in this frame's memory (if we weren't updated this frame)
+	CarryDrawInstances();
+	
+	//On-screen check (checks the first draw instance, which is basically how the original does it)
+	if (drawInstanceCount != 0)
 	{
-		//On-screen check (checks the first draw instance, which is basically how the original does it)
 		int alignX = renderFlags.alignPlane ? gLevel->camera->xPos : 0;
 		int alignY = renderFlags.alignPlane ? gLevel->camera->yPos : 0;
-		int16_t xPos = drawInstances[0]->xPos;
-		int16_t yPos = drawInstances[0]->yPos;
-		
-		renderFlags.isOnscreen = false;
+		int16_t xPos = drawInstances->xPos;
+		int16_t yPos = drawInstances->yPos;
 		
-		if (!(xPos - alignX < -widthPixels || xPos - alignX > gRenderSpec.width + widthPixels) &&
-			!(yPos - alignY < -heightPixels || yPos - alignY > gRenderSpec.height + heightPixels))
+		renderFlags.isOnscreen = !(xPos - alignX < -widthPixels || xPos - alignX > gRenderSpec.width + widthPixels) &&
+								 !(yPos - alignY < -heightPixels || yPos - alignY > gRenderSpec.height + heightPixels);
+	}
+	
+	for (size_t i = 0; i < children.size(); i++)
+		children[i]->CheckOnscreen();
+}
+
+void OBJECT::Draw()
+{
+	//Make sure our draw instances are in this frame's memory (if we weren't updated this frame)
+	CarryDrawInstances();
+	
+	//Draw our draw instances if we were on-screen as of our last step
+	if (drawInstanceCount != 0 && renderFlags.isOnscreen)
+	{
+		//Get how far our draw instances should be offset to draw us between our last two positions
+		int16_t offsetX = 0, offsetY = 0;
+		if (interpolate)
 		{
-			//Draw our draw instances if on-screen and set flag
-			for (size_t i = 0; i < drawInstances.size(); i++)
-				RenderDrawInstance(drawInstances[i]);
-			renderFlags.isOnscreen = true;
+			offsetX = Interpolate(prevXPos, x.pos, gLevel->drawAlpha) - x.pos;
+			offsetY = Interpolate(prevYPos, y.pos, gLevel->drawAlpha) - y.pos;
 		}
+		
+		for (uint16_t i = 0; i < drawInstanceCount; i++)
+			RenderDrawInstance(&drawInstances[i], offsetX, offsetY);
 	}
 	
 	for (size_t i = 0; i < children.size(); i++)
@@ -941,42 +1150,15 @@ void OBJECT::Draw()
 }
 
 //Draw instance draw function
-void OBJECT::RenderDrawInstance(OBJECT_DRAWINSTANCE *drawInstance)
+void OBJECT::RenderDrawInstance(const OBJECT_DRAWINSTANCE *drawInstance, int16_t offsetX, int16_t offsetY)
 {
-	//Don't draw if we don't have textures or mappings
+	//Don't draw if we don't have a texture or valid mapping
 	if (drawInstance->texture != nullptr)
 	{
-		//Draw our sprite
-		RECT mapRect;
-		POINT mapOrig;
-		
-		if (!drawInstance->renderFlags.staticMapping)
-		{
-			//Reject if out of bounds or no mappings are defined
-			if (drawInstance->mapping.mappings == nullptr || drawInstance->mappingFrame >= drawInstance->mapping.mappings->size)
-				return;
-			
-			//Pull rect and origin from mappings list using mappingFrame
-			mapRect = drawInstance->mapping.mappings->rect[drawInstance->mappingFrame];
-			mapOrig = drawInstance->mapping.mappings->origin[drawInstance->mappingFrame];
-		}
-		else
-		{
-			//Just use our static rect and origin
-			mapRect = drawInstance->mapping.rect;
-			mapOrig = drawInstance->mapping.origin;
-		}
-		
-		int origX = mapOrig.x;
-		int origY = mapOrig.y;
-		if (drawInstance->renderFlags.xFlip)
-			origX = mapRect.w - origX;
-		if (drawInstance->renderFlags.yFlip)
-			origY = mapRect.h - origY;
-		
-		//Draw to screen at the given position
-		int alignX = drawInstance->renderFlags.alignPlane ? gLevel->camera->xPos : 0;
-		int alignY = drawInstance->renderFlags.alignPlane ? gLevel->camera->yPos : 0;
-		gSoftwareBuffer->DrawTexture(drawInstance->texture, drawInstance->texture->loadedPalette, &mapRect, gLevel->GetObjectLayer(highPriority, priority), drawInstance->xPos - origX - alignX, drawInstance->yPos - origY - alignY, drawInstance->renderFlags.xFlip, drawInstance->renderFlags.yFlip);
+		//Draw to screen at the given position (offset, and relative to where our camera's drawn)
+		RECT mapRect = {drawInstance->srcX, drawInstance->srcY, drawInstance->srcW, drawInstance->srcH};
+		int alignX = drawInstance->alignPlane ? gLevel->camera->drawXPos : 0;
+		int alignY = drawInstance->alignPlane ? gLevel->camera->drawYPos : 0;
+		gSoftwareBuffer->DrawTexture(drawInstance->texture, drawInstance->texture->loadedPalette, &mapRect, gLevel->GetObjectLayer(drawInstance->highPriority, drawInstance->priority), drawInstance->xPos + offsetX - drawInstance->origX - alignX, drawInstance->yPos + offsetY - drawInstance->origY - alignY, drawInstance->xFlip, drawInstance->yFlip);
 	}
 }
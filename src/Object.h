@@ -2,37 +2,39 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <new>
+#include <vector>
 
 #include "LinkedList.h"
 #include "Render.h"
 #include "Mappings.h"
 #include "LevelCollision.h"
 #include "CommonMacros.h"
+#include "FrameArena.h"
 
 //Declare the object and player classes
 class OBJECT;
 class PLAYER;
+struct OBJECT_LOAD;
 
 //Object function type
 typedef void (*OBJECTFUNCTION)(OBJECT*);
 
 //Constants
-#define OBJECT_PLAYER_REFERENCES 0x100
+#define OBJECT_PLAYER_REFERENCES 8
+#define OBJECTPOOL_CHUNK_SLOTS 0x40
+
+#define OBJECT_SCRATCH_SIZE				0x10	//Scratch this size or smaller is stored in the object itself
+#define OBJECT_SCRATCH_ALIGN			0x08
+#define OBJECT_SCRATCH_OVERFLOW_SIZE	0x100	//Bigger scratch is allocated from the scratch pool, up to this size
+#define OBJECTSCRATCHPOOL_CHUNK_BLOCKS	0x20
+
+#define OBJECT_DRAWINSTANCE_CAPACITY	4	//How many draw instances an object has room for before its array grows
 
 //Common macros
-#define CHECK_LINKEDLIST_OBJECTDELETE(linkedList)	for (LL_NODE<OBJECT*> *node = linkedList.head; node != nullptr;)	\
-													{	\
-														node = linkedList.head;	\
-														for (; node != nullptr; node = node->next)	\
-														{	\
-															if (node->node_entry->deleteFlag)	\
-															{	\
-																delete node->node_entry;	\
-																linkedList.erase_node(node);	\
-																break;	\
-															}	\
-														}	\
-													}
+#define CLEAR_INSTANCE_OBJECTLIST(objectList)	for (size_t i = 0; i < objectList.size(); i++)	\
+													delete objectList[i];	\
+												objectList.clear();
 
 //Enumerations
 enum COLLISIONTYPE
@@ -75,6 +77,13 @@ struct OBJECT_STATUS
 	bool objectSpecific = false;	//Used for anything any specific object wants
 };
 
+struct OBJECT_PLAYERCONTACT
+{
+	bool standing : 1;
+	bool pushing : 1;
+	bool objectSpecific : 1;
+};
+
 struct OBJECT_SOLIDTOUCH
 {
 	bool side[OBJECT_PLAYER_REFERENCES] = {0};
@@ -101,35 +110,81 @@ struct OBJECT_MAPPING
 	MAPPINGS *mappings = nullptr;
 };
 
-//Object drawing instance class
+//Object draw instance (a sprite to draw, with its mapping already looked up)
 struct OBJECT_DRAWINSTANCE
 {
-	OBJECT_RENDERFLAGS renderFlags;
-	TEXTURE *texture;
-	OBJECT_MAPPING mapping;
-	bool highPriority;
-	uint8_t priority;
-	uint16_t mappingFrame;
+	TEXTURE *texture;				//Null if there's nothing to draw (no texture, or an invalid mapping frame)
 	int16_t xPos, yPos;
+	int16_t srcX, srcY, srcW, srcH;	//Source rect in our texture
+	int16_t origX, origY;			//Origin (already flipped)
+	uint8_t priority;
+	bool xFlip : 1;
+	bool yFlip : 1;
+	bool alignPlane : 1;
+	bool highPriority : 1;
 };
 
-//Object class
-class OBJECT
+//Object handle (refers to an object by its pool slot, and stops resolving once the object is deleted)
+struct OBJECT_HANDLE
 {
-	public:
-		//Failure
-		const char *fail = nullptr;
+	uint32_t index = 0;
+	uint32_t generation = 0; //Slots never have a generation of 0, so default handles never resolve
+	
+	inline OBJECT *Get() const;
+};
+
+//Object scratch pool class (fixed-size blocks for scratch that's too big to be stored in an object)
+class OBJECTSCRATCHPOOL
+{
+	private:
+		std::vector<unsigned char*> chunks;
+		std::vector<void*> freeBlocks;
 		
-		//Object sub-type
-		unsigned int subtype = 0;
+	public:
+		//Destructor
+		~OBJECTSCRATCHPOOL();
 		
-		//Rendering stuff
-		OBJECT_RENDERFLAGS renderFlags;
-		LINKEDLIST<OBJECT_DRAWINSTANCE*> drawInstances;
+		//Allocation functions
+		void *Allocate();
+		inline void Free(void *block) { freeBlocks.push_back(block); }
+};
+
+extern OBJECTSCRATCHPOOL gObjectScratchPool;
+
+//Object list (objects referred to by handle, in the order they were linked)
+class OBJECTLIST
+{
+	private:
+		std::vector<OBJECT_HANDLE> handles;
 		
-		//Our texture and mappings
-		TEXTURE *texture = nullptr;
-		OBJECT_MAPPING mapping;
+	public:
+		//Linking and erasing
+		inline void link_back(OBJECT *object);
+		inline void erase(size_t index) { handles.erase(handles.begin() + index); }
+		inline void clear() { handles.clear(); }
+		void delete_flagged();
+		
+		//Random access and size
+		inline OBJECT *at(size_t index) const { return handles[index].Get(); }
+		inline OBJECT *operator[](size_t index) const { return at(index); }
+		inline size_t size() const { return handles.size(); }
+		
+		inline size_t pos_of_val(OBJECT *object) const
+		{
+			size_t i = 0;
+			while (i < handles.size() && handles[i].Get() != object)
+				i++;
+			return i;
+		}
+};
+
+//Object class
+class alignas(0x40) OBJECT
+{
+	public:
+		//Hot data (everything touched by most objects every frame, kept together at the start of the object)
+		//Our object-specific function
+		OBJECTFUNCTION function = nullptr;
 		
 		//Position
 		FPDEF(x, int16_t, pos, uint8_t, sub, int32_t)
@@ -140,88 +195,156 @@ class OBJECT
 		int16_t yVel = 0;		//Global Y-velocity
 		int16_t inertia = 0;	//Generic horizontal velocity
 		
-		//Collision properties
+		//Collision radius
 		int16_t xRadius = 0;
 		int16_t yRadius = 0;
 		
+		//Routine
+		uint8_t routine = 0;			//Routine
+		uint8_t routineSecondary = 0;	//Routine Secondary
+		
+		uint8_t angle = 0;	//Angle
+		
+		//Our status and render flags
+		OBJECT_STATUS status;
+		OBJECT_RENDERFLAGS renderFlags;
+		
+		bool highPriority = false;	//Drawn above the foreground
+		bool deleteFlag = false;	//Delete flag
+		
+		//Touch collision
 		COLLISIONTYPE collisionType = COLLISIONTYPE_NULL;
 		int16_t touchWidth = 0;
 		int16_t touchHeight = 0;
 		
-		struct
-		{
-			bool reflect = false;	//Projectile that gets reflected
-			bool flame = false;		//Flame
-			bool lightning = false;	//Lightning
-			bool aqua = false;		//Aqua
-		} hurtType;
-		
-		//Sprite properties
-		bool highPriority = false;					//Drawn above the foreground
-		unsigned int priority = 0;					//Priority of sprite when drawing
+		//Sprite size
 		int16_t widthPixels = 0, heightPixels = 0;	//Width and height of sprite in pixels (used for on screen checking and balancing)
 		
-		//Animation and mapping
+		//Current mapping frame and animation
 		unsigned int mappingFrame = 0;
+		unsigned int anim = 0;
+		
+		//Cold data
+		//Failure
+		const char *fail = nullptr;
+		
+		//Object sub-type
+		unsigned int subtype = 0;
+		
+		//Spawn sequence (counts up with every object created in the level, for objects that stagger work over frames)
+		unsigned int spawnSequence = 0;
+		
+		//Rendering stuff
+		unsigned int priority = 0;	//Priority of sprite when drawing
 		
+		OBJECT_DRAWINSTANCE *drawInstances = nullptr;		//Our draw instances (an array allocated from the frame arena)
+		uint16_t drawInstanceCount = 0, drawInstanceCapacity = 0;
+		unsigned int drawInstancesGeneration = 0;			//The frame arena generation our draw instances were allocated in
+		
+		int16_t prevXPos = 0, prevYPos = 0;	//Our position before the last simulation step (drawn interpolated from)
+		bool interpolate = false;			//Set if our previous position was saved (we existed before the last step)
+		
+		//Our texture and mappings
+		TEXTURE *texture = nullptr;
+		OBJECT_MAPPING mapping;
+		
+		//Animation
 		unsigned int animFrame = 0;
-		unsigned int anim = 0;
 		unsigned int prevAnim = 0;
 		signed int animFrameDuration = 0;
 		
-		//Our status
-		OBJECT_STATUS status;
-		
-		//Player contact status
+		//Hurt type
 		struct
 		{
-			bool standing = false;
-			bool pushing = false;
-			bool objectSpecific = false;
-		} playerContact[OBJECT_PLAYER_REFERENCES];
+			bool reflect = false;	//Projectile that gets reflected
+			bool flame = false;		//Flame
+			bool lightning = false;	//Lightning
+			bool aqua = false;		//Aqua
+		} hurtType;
 		
-		//Routine
-		uint8_t routine = 0;			//Routine
-		uint8_t routineSecondary = 0;	//Routine Secondary
+		//Player contact status (indexed by the player's index in the level's player list)
+		OBJECT_PLAYERCONTACT playerContact[OBJECT_PLAYER_REFERENCES] = {};
 		
-		uint8_t angle = 0;	//Angle
-		union //Parent
-		{
-			void *parent = nullptr;
-			OBJECT *parentObject;
-			PLAYER *parentPlayer;
-		};
+		//Parent
+		PLAYER *parentPlayer = nullptr;
+		OBJECT_HANDLE parentObject;
 		
-		//Children linked list
-		LINKEDLIST<OBJECT*> children;
+		//Children list
+		OBJECTLIST children;
 		
-		//Scratch memory
-		void *scratch = nullptr; //No specific type - whatever an object specifies
+		//Scratch memory (no specific type - whatever an object specifies, holding a pointer to the scratch pool block if it doesn't fit)
+		alignas(OBJECT_SCRATCH_ALIGN) unsigned char scratch[OBJECT_SCRATCH_SIZE];
+		void (*scratchDestroy)(OBJECT*) = nullptr; //Destroys the scratch's type, set while we have scratch
 		
-		//Our object-specific function
-		OBJECTFUNCTION function = nullptr;
+		//Our previous function
 		OBJECTFUNCTION prevFunction = nullptr;
 		
-		//Delete flag
-		bool deleteFlag = false;
+		//Our object load (if we were loaded from one)
+		OBJECT_LOAD *load = nullptr;
 		
 	public:
 		//Constructor and destructor
 		OBJECT(OBJECTFUNCTION object);
 		~OBJECT();
 		
-		//Scratch allocation function
+		//Objects are allocated from our object pool
+		static void *operator new(size_t size);
+		static void operator delete(void *pointer);
+		
+		inline OBJECT_HANDLE GetHandle() const;
+		
+		//Scratch allocation functions
 		template <typename T> inline T *Scratch()
 		{
-			//Allocate scratch if null, then return it or the already allocated scratch
-			if (scratch == nullptr)
+			static_assert(sizeof(T) <= OBJECT_SCRATCH_OVERFLOW_SIZE, "Scratch type is too big for the scratch pool");
+			static_assert(alignof(T) <= alignof(max_align_t), "Scratch type is aligned too strictly for the scratch pool");
+			
+			//Construct our scratch if we don't have any, then return it
+			if (scratchDestroy == nullptr)
+			{
+				if (ScratchFits<T>())
+				{
+					new (scratch) T();
+				}
+				else
+				{
+					void *block = gObjectScratchPool.Allocate();
+					new (block) T();
+					*((void**)scratch) = block;
+				}
+				scratchDestroy = &DestroyScratch<T>;
+			}
+			return ScratchFits<T>() ? (T*)scratch : *((T**)scratch);
+		}
+		
+		inline void FreeScratch()
+		{
+			if (scratchDestroy != nullptr)
 			{
-				scratch = malloc(sizeof(T)); //Allocate memory (have to use malloc because destructor doesn't know scratch type)
-				*((T*)scratch) = {}; //Explicitly initialize because we used malloc
+				scratchDestroy(this);
+				scratchDestroy = nullptr;
 			}
-			return (T*)scratch;
 		}
 		
+	private:
+		template <typename T> static constexpr bool ScratchFits() { return sizeof(T) <= OBJECT_SCRATCH_SIZE && alignof(T) <= OBJECT_SCRATCH_ALIGN; }
+		
+		template <typename T> static void DestroyScratch(OBJECT *object)
+		{
+			//Destroy our scratch, and free it back to the scratch pool if it didn't fit
+			if (ScratchFits<T>())
+			{
+				((T*)object->scratch)->~T();
+			}
+			else
+			{
+				T *block = *((T**)object->scratch);
+				block->~T();
+				gObjectScratchPool.Free(block);
+			}
+		}
+		
+	public:
 		//Generic object functions
 		void Move();
 		void MoveAndFall();
@@ -234,6 +357,7 @@ class OBJECT
 		int16_t CheckCollisionLeft_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle);
 		int16_t CheckCollisionRight_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle);
 		
+		void CarryDrawInstances();
 		void DrawInstance(OBJECT_RENDERFLAGS iRenderFlags, TEXTURE *iTexture, OBJECT_MAPPING iMapping, bool iHighPriority, uint8_t iPriority, uint16_t iMappingFrame, int16_t iXPos, int16_t iYPos);
 		
 		void UnloadOffscreen(int16_t xPos);
@@ -261,6 +385,60 @@ class OBJECT
 		
 		//Main update and draw functions
 		bool Update();
+		void SavePosition();
+		void CheckOnscreen();
 		void Draw();
-		void RenderDrawInstance(OBJECT_DRAWINSTANCE *drawInstance);
+		void RenderDrawInstance(const OBJECT_DRAWINSTANCE *drawInstance, int16_t offsetX, int16_t offsetY);
+};
+
+//Object pool class (objects are allocated in chunks of slots that never move, so handles can be checked against their slot's generation)
+class OBJECTPOOL
+{
+	private:
+		struct SLOT
+		{
+			alignas(OBJECT) unsigned char object[sizeof(OBJECT)];	//Must be first, so an object's address is its slot's address
+			uint32_t index = 0;
+			uint32_t generation = 1;	//Incremented when the slot's object is deleted, so its handles stop resolving
+			bool alive = false;
+		};
+		
+		std::vector<SLOT*> chunks;
+		std::vector<uint32_t> freeSlots;
+		std::vector<OBJECT*> destroyQueue;
+		
+	public:
+		//Destructor
+		~OBJECTPOOL();
+		
+		//Allocation functions
+		void *Allocate();
+		void Free(void *object);
+		
+		//Deferred destruction (objects are queued while their lists are swept, then destroyed in order)
+		inline void QueueDestroy(OBJECT *object) { destroyQueue.push_back(object); }
+		void DestroyQueued();
+		
+		//Handle functions
+		inline OBJECT_HANDLE GetHandle(const OBJECT *object) const
+		{
+			const SLOT *slot = (const SLOT*)object;
+			return {slot->index, slot->generation};
+		}
+		
+		inline OBJECT *Get(OBJECT_HANDLE handle) const
+		{
+			//Get the object in the handle's slot, if it's still the same object
+			if (handle.index >= chunks.size() * OBJECTPOOL_CHUNK_SLOTS)
+				return nullptr;
+			SLOT *slot = &chunks[handle.index / OBJECTPOOL_CHUNK_SLOTS][handle.index % OBJECTPOOL_CHUNK_SLOTS];
+			return (slot->alive && slot->generation == handle.generation) ? (OBJECT*)slot->object : nullptr;
+		}
 };
+
+extern OBJECTPOOL gObjectPool;
+
+//Handle functions
+inline OBJECT *OBJECT_HANDLE::Get() const { return gObjectPool.Get(*this); }
+inline OBJECT_HANDLE OBJECT::GetHandle() const { return gObjectPool.GetHandle(this); }
+inline void OBJECTLIST::link_back(OBJECT *object) { handles.push_back(object->GetHandle()); }
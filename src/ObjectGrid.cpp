@@ -0,0 +1,97 @@
+#include <algorithm>
+#include "ObjectGrid.h"
+
+//Building functions
+void OBJECTGRID::Clear()
+{
+	//Clear our boxes and grid
+	entries.clear();
+	columns = rows = 0;
+	objects = 0;
+}
+
+void OBJECTGRID::Build(size_t setObjects)
+{
+	objects = setObjects;
+	columns = rows = 0;
+	if (entries.empty())
+		return;
+	
+	//Get the area covered by our boxes
+	int left = entries[0].left, top = entries[0].top, right = entries[0].right, bottom = entries[0].bottom;
+	for (size_t i = 1; i < entries.size(); i++)
+	{
+		left = std::min(left, entries[i].left);
+		top = std::min(top, entries[i].top);
+		right = std::max(right, entries[i].right);
+		bottom = std::max(bottom, entries[i].bottom);
+	}
+	
+	//Get our cell size and grid size (making our cells bigger if there'd be too many)
+	for (cellShift = OBJECTGRID_CELL_SHIFT;; cellShift++)
+	{
+		gridLeft = left >> cellShift;
+		gridTop = top >> cellShift;
+		columns = (right >> cellShift) - gridLeft + 1;
+		rows = (bottom >> cellShift) - gridTop + 1;
+		if ((long)columns * rows <= OBJECTGRID_MAX_CELLS)
+			break;
+	}
+	
+	//Count how many indices go in each cell
+	cellStart.assign(columns * rows + 1, 0);
+	
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const ENTRY &entry = entries[i];
+		for (int y = (entry.top >> cellShift) - gridTop; y <= (entry.bottom >> cellShift) - gridTop; y++)
+			for (int x = (entry.left >> cellShift) - gridLeft; x <= (entry.right >> cellShift) - gridLeft; x++)
+				cellStart[y * columns + x + 1]++;
+	}
+	
+	for (size_t i = 1; i < cellStart.size(); i++)
+		cellStart[i] += cellStart[i - 1];
+	
+	//Fill our cells (entries were added in ascending order, so each cell stays sorted)
+	cellEntries.resize(cellStart.back());
+	cellFill.assign(cellStart.begin(), cellStart.end() - 1);
+	
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const ENTRY &entry = entries[i];
+		for (int y = (entry.top >> cellShift) - gridTop; y <= (entry.bottom >> cellShift) - gridTop; y++)
+			for (int x = (entry.left >> cellShift) - gridLeft; x <= (entry.right >> cellShift) - gridLeft; x++)
+				cellEntries[cellFill[y * columns + x]++] = i;
+	}
+}
+
+//Query function
+const std::vector<uint32_t> &OBJECTGRID::Query(int left, int top, int right, int bottom)
+{
+	results.clear();
+	
+	//Get the cells the area overlaps
+	int cellLeft = std::max((left >> cellShift) - gridLeft, 0);
+	int cellTop = std::max((top >> cellShift) - gridTop, 0);
+	int cellRight = std::min((right >> cellShift) - gridLeft, columns - 1);
+	int cellBottom = std::min((bottom >> cellShift) - gridTop, rows - 1);
+	
+	//Get every index in those cells whose box overlaps the area
+	for (int y = cellTop; y <= cellBottom; y++)
+	{
+		for (int x = cellLeft; x <= cellRight; x++)
+		{
+			for (uint32_t i = cellStart[y * columns + x]; i < cellStart[y * columns + x + 1]; i++)
+			{
+				const ENTRY &entry = entries[cellEntries[i]];
+				if (entry.left <= right && entry.right >= left && entry.top <= bottom && entry.bottom >= top)
+					results.push_back(entry.index);
+			}
+		}
+	}
+	
+	//Sort our indices and remove any that were in more than one cell
+	std::sort(results.begin(), results.end());
+	results.erase(std::unique(results.begin(), results.end()), results.end());
+	return results;
+}
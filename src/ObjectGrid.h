@@ -0,0 +1,47 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//Object grid constants
+#define OBJECTGRID_CELL_SHIFT	7		//Smallest cell size (0x80 pixels, the same as the object load chunks)
+#define OBJECTGRID_MAX_CELLS	0x400	//Cells are made bigger if the objects are spread out over more than this many
+
+//Object grid class (a uniform grid of object list indices, rebuilt every frame, so an area can be checked without going through every object)
+class OBJECTGRID
+{
+	private:
+		//Boxes added this frame
+		struct ENTRY
+		{
+			uint32_t index;
+			int left, top, right, bottom;
+		};
+		
+		std::vector<ENTRY> entries;
+		
+		//Our grid
+		int gridLeft = 0, gridTop = 0;
+		int columns = 0, rows = 0;
+		int cellShift = OBJECTGRID_CELL_SHIFT;
+		
+		std::vector<uint32_t> cellStart;	//Where each cell's entries start in cellEntries (with one more at the end)
+		std::vector<uint32_t> cellEntries;	//The entries in each cell, in ascending order
+		std::vector<uint32_t> cellFill;
+		
+		//Query results
+		std::vector<uint32_t> results;
+	
+	public:
+		//How many objects were in the list when we were built (anything linked after wasn't added)
+		size_t objects = 0;
+	
+	public:
+		//Building functions
+		void Clear();
+		inline void Add(size_t index, int left, int top, int right, int bottom) { entries.push_back({(uint32_t)index, left, top, right, bottom}); }
+		void Build(size_t setObjects);
+		
+		//Get the indices of every box overlapping the given area (in ascending order)
+		const std::vector<uint32_t> &Query(int left, int top, int right, int bottom);
+};
@@ -58,7 +58,7 @@ void ObjBouncingRing(OBJECT *object)
 				object->yLong += object->yVel * 0x100;
 			object->yVel += 0x18;
 			
-			if (((gLevel->frameCounter + gLevel->objectList.pos_of_val(object)) & BOUNCINGRING_COLLISIONSTEP) == 0)
+			if (((gLevel->frameCounter + object->spawnSequence) & BOUNCINGRING_COLLISIONSTEP) == 0)
 			{
 				//Check for collision with the floor or ceiling
 				int16_t checkVel = object->yVel;
@@ -55,7 +55,8 @@ void ObjBuzzBomberMissile(OBJECT *object)
 		case 1: //Charging fire
 		{
 			//Check if the buzz bomber has been destroyed
-			if (object->parentObject == nullptr || object->parentObject->deleteFlag == true || object->parentObject->function == &ObjExplosion)
+			OBJECT *parent = object->parentObject.Get();
+			if (parent == nullptr || parent->deleteFlag == true || parent->function == &ObjExplosion)
 			{
 				object->deleteFlag = true;
 				break;
@@ -175,7 +176,7 @@ void ObjBuzzBomber(OBJECT *object)
 							projectile->x.pos = object->x.pos + xOff;
 							projectile->y.pos = object->y.pos + 28;
 							projectile->status = object->status;
-							projectile->parentObject = object;
+							projectile->parentObject = object->GetHandle();
 							gLevel->objectList.link_back(projectile);
 							
 							//Update our state
@@ -126,7 +126,7 @@ void ObjCrabmeat(OBJECT *object)
 			object->MoveAndFall();
 			
 			//Check for the floor
-			uint8_t nextAngle;
+			uint8_t nextAngle = 0;
 			int16_t distance = object->CheckCollisionDown_1Point(COLLISIONLAYER_NORMAL_TOP, object->x.pos, object->y.pos + object->yRadius, &nextAngle);
 			if (distance >= 0)
 				break;
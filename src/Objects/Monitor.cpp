@@ -149,7 +149,7 @@ void ObjMonitorContents(OBJECT *object)
 				object->animFrameDuration = 29;
 				
 				//Handle our item
-				PLAYER *breakPlayer = object->parentObject->parentPlayer;
+				PLAYER *breakPlayer = object->parentPlayer;
 				
 				switch (object->anim)
 				{
@@ -282,7 +282,7 @@ void ObjMonitor(OBJECT *object)
 			content->x.pos = object->x.pos;
 			content->y.pos = object->y.pos;
 			content->anim = object->anim;
-			content->parentObject = object;
+			content->parentPlayer = object->parentPlayer; //Copied, as we can unload before our contents rise
 			gLevel->objectList.link_back(content);
 			
 			//Create the explosion
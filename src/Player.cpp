@@ -991,8 +991,16 @@ uint8_t PLAYER::GetCloserFloor_General(uint8_t angleSide, int16_t *distance, int
 //2-point collision checks
 void PLAYER::CheckCollisionDown_2Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, int16_t *distance, int16_t *distance2, uint8_t *outAngle)
 {
-	int16_t retDistance = GetCollisionV(xPos + xRadius, yPos, layer, false, &floorAngle1);
-	int16_t retDistance2 = GetCollisionV(xPos - xRadius, yPos, layer, false, &floorAngle2);
+	COLLISIONPROBE probe[2] = {
+		COLLISIONPROBE(xPos + xRadius, yPos, COLLISIONDIRECTION_DOWN, layer, floorAngle1),
+		COLLISIONPROBE(xPos - xRadius, yPos, COLLISIONDIRECTION_DOWN, layer, floorAngle2),
+	};
+	GetCollisionBatch(probe, 2);
+	floorAngle1 = probe[0].angle;
+	floorAngle2 = probe[1].angle;
+	
+	int16_t retDistance = probe[0].distance;
+	int16_t retDistance2 = probe[1].distance;
 
 	uint8_t retAngle = GetCloserFloor_General(0x00, &retDistance, &retDistance2);
 	if (distance != nullptr)
@@ -1005,8 +1013,16 @@ void PLAYER::CheckCollisionDown_2Point(COLLISIONLAYER layer, int16_t xPos, int16
 
 void PLAYER::CheckCollisionUp_2Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, int16_t *distance, int16_t *distance2, uint8_t *outAngle)
 {
-	int16_t retDistance = GetCollisionV(xPos + xRadius, yPos, layer, true, &floorAngle1);
-	int16_t retDistance2 = GetCollisionV(xPos - xRadius, yPos, layer, true, &floorAngle2);
+	COLLISIONPROBE probe[2] = {
+		COLLISIONPROBE(xPos + xRadius, yPos, COLLISIONDIRECTION_UP, layer, floorAngle1),
+		COLLISIONPROBE(xPos - xRadius, yPos, COLLISIONDIRECTION_UP, layer, floorAngle2),
+	};
+	GetCollisionBatch(probe, 2);
+	floorAngle1 = probe[0].angle;
+	floorAngle2 = probe[1].angle;
+	
+	int16_t retDistance = probe[0].distance;
+	int16_t retDistance2 = probe[1].distance;
 
 	uint8_t retAngle = GetCloserFloor_General(0x80, &retDistance, &retDistance2);
 	if (distance != nullptr)
@@ -1019,8 +1035,16 @@ void PLAYER::CheckCollisionUp_2Point(COLLISIONLAYER layer, int16_t xPos, int16_t
 
 void PLAYER::CheckCollisionLeft_2Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, int16_t *distance, int16_t *distance2, uint8_t *outAngle)
 {
-	int16_t retDistance = GetCollisionH(xPos, yPos - xRadius, layer, true, &floorAngle1);
-	int16_t retDistance2 = GetCollisionH(xPos, yPos + xRadius, layer, true, &floorAngle2);
+	COLLISIONPROBE probe[2] = {
+		COLLISIONPROBE(xPos, yPos - xRadius, COLLISIONDIRECTION_LEFT, layer, floorAngle1),
+		COLLISIONPROBE(xPos, yPos + xRadius, COLLISIONDIRECTION_LEFT, layer, floorAngle2),
+	};
+	GetCollisionBatch(probe, 2);
+	floorAngle1 = probe[0].angle;
+	floorAngle2 = probe[1].angle;
+	
+	int16_t retDistance = probe[0].distance;
+	int16_t retDistance2 = probe[1].distance;
 
 	uint8_t retAngle = GetCloserFloor_General(0x40, &retDistance, &retDistance2);
 	if (distance != nullptr)
@@ -1033,8 +1057,16 @@ void PLAYER::CheckCollisionLeft_2Point(COLLISIONLAYER layer, int16_t xPos, int16
 
 void PLAYER::CheckCollisionRight_2Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, int16_t *distance, int16_t *distance2, uint8_t *outAngle)
 {
-	int16_t retDistance = GetCollisionH(xPos, yPos - xRadius, layer, false, &floorAngle1);
-	int16_t retDistance2 = GetCollisionH(xPos, yPos + xRadius, layer, false, &floorAngle2);
+	COLLISIONPROBE probe[2] = {
+		COLLISIONPROBE(xPos, yPos - xRadius, COLLISIONDIRECTION_RIGHT, layer, floorAngle1),
+		COLLISIONPROBE(xPos, yPos + xRadius, COLLISIONDIRECTION_RIGHT, layer, floorAngle2),
+	};
+	GetCollisionBatch(probe, 2);
+	floorAngle1 = probe[0].angle;
+	floorAngle2 = probe[1].angle;
+	
+	int16_t retDistance = probe[0].distance;
+	int16_t retDistance2 = probe[1].distance;
 
 	uint8_t retAngle = GetCloserFloor_General(0xC0, &retDistance, &retDistance2);
 	if (distance != nullptr)
@@ -1048,34 +1080,42 @@ void PLAYER::CheckCollisionRight_2Point(COLLISIONLAYER layer, int16_t xPos, int1
 //Get distance functions
 int16_t PLAYER::CheckCollisionDown_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionV(xPos, yPos, layer, false, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x00 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_DOWN, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x00 : probe.angle;
+	return probe.distance;
 }
 
 int16_t PLAYER::CheckCollisionUp_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionV(xPos, yPos, layer, true, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x80 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_UP, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x80 : probe.angle;
+	return probe.distance;
 }
 
 int16_t PLAYER::CheckCollisionLeft_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionH(xPos, yPos, layer, true, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0x40 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_LEFT, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0x40 : probe.angle;
+	return probe.distance;
 }
 
 int16_t PLAYER::CheckCollisionRight_1Point(COLLISIONLAYER layer, int16_t xPos, int16_t yPos, uint8_t *outAngle)
 {
-	int16_t distance = GetCollisionH(xPos, yPos, layer, false, outAngle);
-	if (outAngle != nullptr)
-		*outAngle = ((*outAngle) & 1) ? 0xC0 : (*outAngle);
-	return distance;
+	COLLISIONPROBE probe(xPos, yPos, COLLISIONDIRECTION_RIGHT, layer, 0);
+	GetCollisionBatch(&probe, 1);
+	
+	if (outAngle != nullptr && probe.found)
+		*outAngle = (probe.angle & 1) ? 0xC0 : probe.angle;
+	return probe.distance;
 }
 
 //Calculate room perpendicular to the given angle (90 degrees clockwise)
@@ -1218,8 +1258,16 @@ void PLAYER::GroundFloorCollision()
 		{
 			case 0x00: //Floor
 			{
-				int16_t distance = GetCollisionV(x.pos + xRadius, y.pos + yRadius, topSolidLayer, false, &floorAngle1);
-				int16_t distance2 = GetCollisionV(x.pos - xRadius, y.pos + yRadius, topSolidLayer, false, &floorAngle2);
+				COLLISIONPROBE probe[2] = {
+					COLLISIONPROBE(x.pos + xRadius, y.pos + yRadius, COLLISIONDIRECTION_DOWN, topSolidLayer, floorAngle1),
+					COLLISIONPROBE(x.pos - xRadius, y.pos + yRadius, COLLISIONDIRECTION_DOWN, topSolidLayer, floorAngle2),
+				};
+				GetCollisionBatch(probe, 2);
+				floorAngle1 = probe[0].angle;
+				floorAngle2 = probe[1].angle;
+				
+				int16_t distance = probe[0].distance;
+				int16_t distance2 = probe[1].distance;
 				int16_t nearestDifference = GetCloserFloor_Ground(distance, distance2);
 				
 				if (nearestDifference < 0)
@@ -1253,8 +1301,16 @@ void PLAYER::GroundFloorCollision()
 			
 			case 0x40: //Wall to the left of us
 			{
-				int16_t distance = GetCollisionH(x.pos - yRadius, y.pos - xRadius, topSolidLayer, true, &floorAngle1);
-				int16_t distance2 = GetCollisionH(x.pos - yRadius, y.pos + xRadius, topSolidLayer, true, &floorAngle2);
+				COLLISIONPROBE probe[2] = {
+					COLLISIONPROBE(x.pos - yRadius, y.pos - xRadius, COLLISIONDIRECTION_LEFT, topSolidLayer, floorAngle1),
+					COLLISIONPROBE(x.pos - yRadius, y.pos + xRadius, COLLISIONDIRECTION_LEFT, topSolidLayer, floorAngle2),
+				};
+				GetCollisionBatch(probe, 2);
+				floorAngle1 = probe[0].angle;
+				floorAngle2 = probe[1].angle;
+				
+				int16_t distance = probe[0].distance;
+				int16_t distance2 = probe[1].distance;
 				int16_t nearestDifference = GetCloserFloor_Ground(distance, distance2);
 				
 				if (nearestDifference < 0)
@@ -1288,8 +1344,16 @@ void PLAYER::GroundFloorCollision()
 			
 			case 0x80: //Ceiling
 			{
-				int16_t distance = GetCollisionV(x.pos + xRadius, y.pos - yRadius, topSolidLayer, true, &floorAngle1);
-				int16_t distance2 = GetCollisionV(x.pos - xRadius, y.pos - yRadius, topSolidLayer, true, &floorAngle2);
+				COLLISIONPROBE probe[2] = {
+					COLLISIONPROBE(x.pos + xRadius, y.pos - yRadius, COLLISIONDIRECTION_UP, topSolidLayer, floorAngle1),
+					COLLISIONPROBE(x.pos - xRadius, y.pos - yRadius, COLLISIONDIRECTION_UP, topSolidLayer, floorAngle2),
+				};
+				GetCollisionBatch(probe, 2);
+				floorAngle1 = probe[0].angle;
+				floorAngle2 = probe[1].angle;
+				
+				int16_t distance = probe[0].distance;
+				int16_t distance2 = probe[1].distance;
 				int16_t nearestDifference = GetCloserFloor_Ground(distance, distance2);
 				
 				if (nearestDifference < 0)
@@ -1323,8 +1387,16 @@ void PLAYER::GroundFloorCollision()
 			
 			case 0xC0: //Wall to the right of us
 			{
-				int16_t distance = GetCollisionH(x.pos + yRadius, y.pos - xRadius, topSolidLayer, false, &floorAngle1);
-				int16_t distance2 = GetCollisionH(x.pos + yRadius, y.pos + xRadius, topSolidLayer, false, &floorAngle2);
+				COLLISIONPROBE probe[2] = {
+					COLLISIONPROBE(x.pos + yRadius, y.pos - xRadius, COLLISIONDIRECTION_RIGHT, topSolidLayer, floorAngle1),
+					COLLISIONPROBE(x.pos + yRadius, y.pos + xRadius, COLLISIONDIRECTION_RIGHT, topSolidLayer, floorAngle2),
+				};
+				GetCollisionBatch(probe, 2);
+				floorAngle1 = probe[0].angle;
+				floorAngle2 = probe[1].angle;
+				
+				int16_t distance = probe[0].distance;
+				int16_t distance2 = probe[1].distance;
 				int16_t nearestDifference = GetCloserFloor_Ground(distance, distance2);
 				
 				if (nearestDifference < 0)
@@ -3665,10 +3737,10 @@ static const uint8_t sonicPalette[16][4][3] = {
 	{{0xFF, 0xFF, 0x24}, {0xFF, 0xFF, 0x91}, {0xFF, 0xFF, 0xDA}, {0xFF, 0xFF, 0xFF}},
 };
 
-#define SET_PALETTE_FROM_ENTRY(pal, entry)	pal->colour[2].SetColour(true, false, true, entry[0][0], entry[0][1], entry[0][2]);	\
-											pal->colour[3].SetColour(true, false, true, entry[1][0], entry[1][1], entry[1][2]);	\
-											pal->colour[4].SetColour(true, false, true, entry[2][0], entry[2][1], entry[2][2]);	\
-											pal->colour[5].SetColour(true, false, true, entry[3][0], entry[3][1], entry[3][2]);
+#define SET_PALETTE_FROM_ENTRY(pal, entry)	pal->SetColour(2, true, false, true, entry[0][0], entry[0][1], entry[0][2]);	\
+											pal->SetColour(3, true, false, true, entry[1][0], entry[1][1], entry[1][2]);	\
+											pal->SetColour(4, true, false, true, entry[2][0], entry[2][1], entry[2][2]);	\
+											pal->SetColour(5, true, false, true, entry[3][0], entry[3][1], entry[3][2]);
 
 void PLAYER::SuperPaletteCycle()
 {
@@ -4677,6 +4749,19 @@ void PLAYER::Draw_UpdateStatus()
 }
 
 //Drawing to the screen
+void PLAYER::CheckOnscreen()
+{
+	//Check if on-screen (only if we'd be drawn, otherwise our flag is left as it was)
+	if (isDrawing && texture != nullptr && mappings != nullptr)
+	{
+		int alignX = renderFlags.alignPlane ? gLevel->camera->xPos : 0;
+		int alignY = renderFlags.alignPlane ? gLevel->camera->yPos : 0;
+		
+		renderFlags.isOnscreen = !(x.pos - alignX < -widthPixels || x.pos - alignX > gRenderSpec.width + widthPixels) &&
+								 !(y.pos - alignY < -heightPixels || y.pos - alignY > gRenderSpec.height + heightPixels);
+	}
+}
+
 void PLAYER::DrawToScreen()
 {
 	if (isDrawing)
@@ -4695,18 +4780,15 @@ void PLAYER::DrawToScreen()
 			if (renderFlags.yFlip)
 				origY = mapRect->h - origY;
 			
-			int alignX = renderFlags.alignPlane ? gLevel->camera->xPos : 0;
-			int alignY = renderFlags.alignPlane ? gLevel->camera->yPos : 0;
-			
-			//Check if on-screen
-			renderFlags.isOnscreen = false;
-			
-			if (!(x.pos - alignX < -widthPixels || x.pos - alignX > gRenderSpec.width + widthPixels) &&
-				!(y.pos - alignY < -heightPixels || y.pos - alignY > gRenderSpec.height + heightPixels))
+			//Draw if we were on-screen as of our last step
+			if (renderFlags.isOnscreen)
 			{
-				//We're on-screen, now set flag and draw
-				renderFlags.isOnscreen = true;
-				gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, mapRect, gLevel->GetObjectLayer(highPriority, priority), x.pos - origX - alignX, y.pos - origY - alignY, renderFlags.xFlip, renderFlags.yFlip);
+				//Draw between our last two positions, relative to where our camera's drawn
+				int drawAlignX = renderFlags.alignPlane ? gLevel->camera->drawXPos : 0;
+				int drawAlignY = renderFlags.alignPlane ? gLevel->camera->drawYPos : 0;
+				int drawX = Interpolate(prevXPos, x.pos, gLevel->drawAlpha);
+				int drawY = Interpolate(prevYPos, y.pos, gLevel->drawAlpha);
+				gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, mapRect, gLevel->GetObjectLayer(highPriority, priority), drawX - origX - drawAlignX, drawY - origY - drawAlignY, renderFlags.xFlip, renderFlags.yFlip);
 				
 				//Draw trail when using speed shoes or hyper
 				if (item.hasSpeedShoes || hyper)
@@ -4720,7 +4802,7 @@ void PLAYER::DrawToScreen()
 					
 					//Draw at the position from the frame above
 					int x = record[(recordPos - trailSeek) % (unsigned)PLAYER_RECORD_LENGTH].x, y = record[(recordPos - trailSeek) % (unsigned)PLAYER_RECORD_LENGTH].y;
-					gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, mapRect, gLevel->GetObjectLayer(highPriority, priority), x - origX - alignX, y - origY - alignY, renderFlags.xFlip, renderFlags.yFlip);
+					gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, mapRect, gLevel->GetObjectLayer(highPriority, priority), x - origX - drawAlignX, y - origY - drawAlignY, renderFlags.xFlip, renderFlags.yFlip);
 				}
 			}
 		}
@@ -4850,7 +4932,7 @@ void PLAYER::RingAttractCheck(OBJECT *object)
 			//Turn this ring into an attracted ring
 			gLevel->ReleaseObjectLoad(object);
 			object->function = ObjAttractRing;
-			object->parent = (void*)this;
+			object->parentPlayer = this;
 		}
 	}
 	
@@ -4956,10 +5038,17 @@ bool PLAYER::ObjectTouch(OBJECT *object, int16_t playerLeft, int16_t playerTop,
 
 void PLAYER::CheckObjectTouch()
 {
-	//Check for ring attraction
+	//Check for ring attraction (against the level's placed rings, then the rings in range in the ring grid, then anything linked since it was built)
 	if (barrier == BARRIER_LIGHTNING)
-		for (size_t i = 0; i < gLevel->objectList.size(); i++)
+	{
+		gLevel->ringManager->Attract(this, RING_ATTRACT_RADIUS);
+		
+		const std::vector<uint32_t> &rings = gLevel->ringGrid.Query(x.pos - RING_ATTRACT_RADIUS, y.pos - RING_ATTRACT_RADIUS, x.pos + RING_ATTRACT_RADIUS, y.pos + RING_ATTRACT_RADIUS);
+		for (size_t i = 0; i < rings.size(); i++)
+			RingAttractCheck(gLevel->objectList[rings[i]]);
+		for (size_t i = gLevel->ringGrid.objects; i < gLevel->objectList.size(); i++)
 			RingAttractCheck(gLevel->objectList[i]);
+	}
 	
 	//Get our collision hitbox
 	bool wasInvincible = item.isInvincible; //Remember if we were invincible, since this gets temporarily overwritten by the double spin attack
@@ -5001,13 +5090,18 @@ void PLAYER::CheckObjectTouch()
 		#endif
 	}
 	
-	//Iterate through every object
-	for (size_t i = 0; i < gLevel->objectList.size(); i++)
-	{
-		//Check for collision with this object
-		if (ObjectTouch(gLevel->objectList[i], playerLeft, playerTop, playerWidth, playerHeight))
-			break;
-	}
+	//Collect any of the level's placed rings we're touching
+	gLevel->ringManager->Touch(this, playerLeft, playerTop, playerWidth, playerHeight);
+	
+	//Iterate through every object overlapping us in the touch grid, then anything linked since it was built (in object list order, stopping at the first we hit)
+	int playerRight = playerLeft + playerWidth, playerBottom = playerTop + playerHeight;
+	const std::vector<uint32_t> &touching = gLevel->touchGrid.Query(mmin(playerLeft, playerRight), mmin(playerTop, playerBottom), mmax(playerLeft, playerRight), mmax(playerTop, playerBottom));
+	bool hit = false;
+	
+	for (size_t i = 0; i < touching.size() && !hit; i++)
+		hit = ObjectTouch(gLevel->objectList[touching[i]], playerLeft, playerTop, playerWidth, playerHeight);
+	for (size_t i = gLevel->touchGrid.objects; i < gLevel->objectList.size() && !hit; i++)
+		hit = ObjectTouch(gLevel->objectList[i], playerLeft, playerTop, playerWidth, playerHeight);
 	
 	//Restore our original invincibility to before the double spin attack modified it
 	item.isInvincible = wasInvincible;
@@ -136,6 +136,8 @@ class PLAYER
 		FPDEF(x, int16_t, pos, uint8_t, sub, int32_t)
 		FPDEF(y, int16_t, pos, uint8_t, sub, int32_t)
 		
+		int16_t prevXPos = 0, prevYPos = 0; //Our position before the last simulation step (drawn interpolated from)
+		
 		//Current routine
 		PLAYER_ROUTINE routine = PLAYERROUTINE_CONTROL;
 		
@@ -416,6 +418,7 @@ class PLAYER
 		void Draw();
 		void Draw_UpdateStatus();
 		
+		void CheckOnscreen();
 		void DrawToScreen();
 		
 		void RestoreStateDebug();
@@ -1,18 +1,33 @@
+#include <string.h>
+#include <algorithm>
 #include "Backend/Render.h"
 #include "Render.h"
 #include "GameConstants.h"
 #include "Log.h"
 #include "Error.h"
 #include "Filesystem.h"
+#include "WorkerPool.h"
+#include "Bench.h"
 
 //Render specification
-RENDERSPEC gRenderSpec = {398, 224, 2, 60.0, false, false};
+RENDERSPEC gRenderSpec = {398, 224, 2, 60.0, false, false, false};
 
 SOFTWAREBUFFER *gSoftwareBuffer;
 
 //Render format
 PIXELFORMAT gPixelFormat;
 
+//Display refresh rate (0 if we can't present at it), and how we're currently paced
+double gRefreshRate = 0.0;
+RENDERPACING gRenderPacing = RENDERPACING_FRAMERATE;
+
+//Area of the output buffer drawn to this frame
+RECT gOutputDirty = {0, 0, 0, 0};
+
+//Palette generation and texture id counters
+unsigned int gPaletteGeneration = 0;
+static unsigned int textureIds = 0;
+
 //Bitmap constants / enumerations
 enum BMPCMP
 {
@@ -26,6 +41,7 @@ enum BMPCMP
 TEXTURE::TEXTURE(std::string path)
 {
 	LOG(("Loading texture from %s... ", path.c_str()));
+	id = ++textureIds;
 	
 	//Open our given file file
 	FS_FILE fp(gBasePath + (source = path), "rb");
@@ -123,7 +139,7 @@ TEXTURE::TEXTURE(std::string path)
 				fp.ReadU8();	//RESERVED - ???
 			
 			//Copy to the loaded palette
-			loadedPalette->colour[i].SetColour(true, true, true, r, g, b);
+			loadedPalette->SetColour(i, true, true, true, r, g, b);
 		}
 		
 		//Allocate and read texture data
@@ -173,6 +189,9 @@ TEXTURE::TEXTURE(std::string path)
 		return;
 	}
 	
+	//Find which rows are opaque
+	FindOpaqueRows();
+	
 	LOG(("Success!\n"));
 }
 
@@ -180,14 +199,67 @@ TEXTURE::~TEXTURE()
 {
 	//Unload texture data
 	delete[] texture;
+	delete[] rowOpaque;
+}
+
+void TEXTURE::FindOpaqueRows()
+{
+	//Check each row for transparent pixels
+	delete[] rowOpaque;
+	rowOpaque = new bool[height];
+	opaque = true;
+	
+	for (int y = 0; y < height; y++)
+	{
+		rowOpaque[y] = memchr(texture + y * width, 0, width) == nullptr;
+		if (!rowOpaque[y])
+			opaque = false;
+	}
+}
+
+//Render queue layer class
+void RENDERQUEUE_LAYER::NewBlock()
+{
+	//Allocate a new block from the frame arena and link it in front of our previous one
+	RENDERQUEUE_BLOCK *newBlock = (RENDERQUEUE_BLOCK*)gFrameArena->Alloc(sizeof(RENDERQUEUE_BLOCK));
+	newBlock->next = head;
+	newBlock->size = 0;
+	head = newBlock;
 }
 
 //Software buffer class
-SOFTWAREBUFFER::SOFTWAREBUFFER(const int bufWidth, const int bufHeight)
+SOFTWAREBUFFER::SOFTWAREBUFFER(const int bufWidth, const int bufHeight, const bool setTrackDirty)
 {
 	//Set our dimensions
 	width = bufWidth;
 	height = bufHeight;
+	
+	//Allocate our back buffer and tile hashes if tracking dirty rectangles
+	if ((trackDirty = setTrackDirty))
+	{
+		backBuffer = new uint8_t[width * height * gPixelFormat.bytesPerPixel]{};
+		tilesX = (width + RENDER_DIRTY_TILE - 1) / RENDER_DIRTY_TILE;
+		tilesY = (height + RENDER_DIRTY_TILE - 1) / RENDER_DIRTY_TILE;
+		tileHash.resize(tilesX * tilesY);
+		lastTileHash.resize(tilesX * tilesY);
+	}
+	
+	//Create our worker pool
+	size_t threads = std::thread::hardware_concurrency();
+	if (threads < 1)
+		threads = 1;
+	if (threads > RENDER_MAX_THREADS)
+		threads = RENDER_MAX_THREADS;
+	workers = new WORKERPOOL(threads);
+}
+
+SOFTWAREBUFFER::~SOFTWAREBUFFER()
+{
+	//Stop our worker pool
+	delete workers;
+	
+	//Free our back buffer
+	delete[] backBuffer;
 }
 
 //Drawing functions
@@ -205,8 +277,8 @@ void SOFTWAREBUFFER::DrawPoint(const int layer, const POINT *point, const COLOUR
 	newEntry.dest = {point->x, point->y, 1, 1};
 	newEntry.solid.colour = colour;
 	
-	//Link to queue
-	queue[layer].link_front(newEntry);
+	//Push to queue
+	queue[layer].Push(newEntry);
 }
 
 void SOFTWAREBUFFER::DrawQuad(const int layer, const RECT *quad, const COLOUR *colour)
@@ -244,10 +316,10 @@ void SOFTWAREBUFFER::DrawQuad(const int layer, const RECT *quad, const COLOUR *c
 	if (newEntry.dest.w <= 0 || newEntry.dest.h <= 0)
 		return;
 	
-	//Finish setting up entry and link to queue
+	//Finish setting up entry and push to queue
 	newEntry.type = RENDERQUEUE_SOLID;
 	newEntry.solid.colour = colour;
-	queue[layer].link_front(newEntry);
+	queue[layer].Push(newEntry);
 }
 
 void SOFTWAREBUFFER::DrawTexture(TEXTURE *texture, PALETTE *palette, const RECT *src, int layer, int x, int y, bool xFlip, bool yFlip)
@@ -307,22 +379,254 @@ void SOFTWAREBUFFER::DrawTexture(TEXTURE *texture, PALETTE *palette, const RECT
 	newEntry.texture.xFlip = xFlip;
 	newEntry.texture.yFlip = yFlip;
 	
-	//Link to queue
-	queue[layer].link_front(newEntry);
+	//Push to queue
+	queue[layer].Push(newEntry);
+}
+
+void SOFTWAREBUFFER::DrawTilemap(TEXTURE *texture, PALETTE *palette, const uint16_t *cell, const int mapWidth, const int mapHeight, const int srcX, const int layer, const int x, const int y)
+{
+	//Don't draw empty maps
+	if (mapWidth <= 0 || mapHeight <= 0)
+		return;
+	
+	//Don't draw if entirely off-screen
+	if (x >= width || y >= height || x + mapWidth * 16 <= 0 || y + mapHeight * 16 <= 0)
+		return;
+	
+	//Setup our queue entry (clipped when rasterized)
+	RENDERQUEUE newEntry;
+	newEntry.type = RENDERQUEUE_TILEMAP;
+	newEntry.dest = {x, y, mapWidth * 16, mapHeight * 16};
+	newEntry.tilemap.cell = cell;
+	newEntry.tilemap.palette = palette;
+	newEntry.tilemap.texture = texture;
+	newEntry.tilemap.width = mapWidth;
+	newEntry.tilemap.height = mapHeight;
+	newEntry.tilemap.srcX = srcX;
+	
+	//Push to queue
+	queue[layer].Push(newEntry);
+}
+
+//Rasterization functions
+void SOFTWAREBUFFER::PrepareQueue()
+{
+	//Make sure every palette we're going to draw with has an up to date native colour table, since the bands can't rebuild them in parallel
+	for (int i = 0; i < RENDERLAYERS; i++)
+	{
+		for (RENDERQUEUE_BLOCK *block = queue[i].head; block != nullptr; block = block->next)
+		{
+			for (size_t v = 0; v < block->size; v++)
+			{
+				const RENDERQUEUE *entry = &block->entry[v];
+				if (entry->type == RENDERQUEUE_TEXTURE)
+					entry->texture.palette->GetNative();
+				else if (entry->type == RENDERQUEUE_TILEMAP)
+					entry->tilemap.palette->GetNative();
+			}
+		}
+	}
+}
+
+//Dirty rectangle tracking
+static inline uint64_t MixHash(uint64_t hash, const uint64_t value)
+{
+	hash = (hash ^ value) * 0x9E3779B97F4A7C15ULL;
+	return hash ^ (hash >> 29);
+}
+
+void SOFTWAREBUFFER::FindDirty(const COLOUR *backgroundColour)
+{
+	//Start every tile with our background colour (or lack of one)
+	std::fill(tileHash.begin(), tileHash.end(), MixHash(0, backgroundColour != nullptr ? backgroundColour->colour : ~0ULL));
+	
+	//Mix every entry into the tiles it covers, in the order they're drawn
+	for (int i = RENDERLAYERS - 1; i >= 0; i--)
+	{
+		for (RENDERQUEUE_BLOCK *block = queue[i].head; block != nullptr; block = block->next)
+		{
+			for (size_t v = block->size; v-- > 0;)
+			{
+				const RENDERQUEUE *entry = &block->entry[v];
+				
+				//Get the area we cover (tilemaps aren't clipped when queued)
+				const int left = std::max(entry->dest.x, 0), right = std::min(entry->dest.x + entry->dest.w, width);
+				const int top = std::max(entry->dest.y, 0), bottom = std::min(entry->dest.y + entry->dest.h, height);
+				if (left >= right || top >= bottom)
+					continue;
+				
+				//Hash everything that decides what we draw (textures never change once loaded, palettes are identified by their generation)
+				uint64_t key = MixHash(entry->type, ((uint64_t)(uint32_t)entry->dest.x << 32) | (uint32_t)entry->dest.y);
+				key = MixHash(key, ((uint64_t)(uint32_t)entry->dest.w << 32) | (uint32_t)entry->dest.h);
+				
+				switch (entry->type)
+				{
+					case RENDERQUEUE_TEXTURE:
+						key = MixHash(key, ((uint64_t)(uint32_t)entry->texture.srcX << 32) | (uint32_t)entry->texture.srcY);
+						key = MixHash(key, ((uint64_t)entry->texture.texture->id << 32) | entry->texture.palette->generation);
+						key = MixHash(key, (entry->texture.xFlip ? 1 : 0) | (entry->texture.yFlip ? 2 : 0));
+						break;
+					case RENDERQUEUE_SOLID:
+						key = MixHash(key, entry->solid.colour->colour);
+						break;
+					case RENDERQUEUE_TILEMAP:
+						key = MixHash(key, ((uint64_t)entry->tilemap.texture->id << 32) | entry->tilemap.palette->generation);
+						key = MixHash(key, ((uint64_t)(uint32_t)entry->tilemap.srcX << 32) | (uint32_t)entry->tilemap.width);
+						break;
+					default:
+						break;
+				}
+				
+				//Mix our key into each tile we cover
+				for (int ty = top / RENDER_DIRTY_TILE; ty <= (bottom - 1) / RENDER_DIRTY_TILE; ty++)
+				{
+					for (int tx = left / RENDER_DIRTY_TILE; tx <= (right - 1) / RENDER_DIRTY_TILE; tx++)
+					{
+						uint64_t hash = MixHash(tileHash[ty * tilesX + tx], key);
+						
+						//Tilemaps also mix in the cells they draw in this tile
+						if (entry->type == RENDERQUEUE_TILEMAP)
+						{
+							const int cellLeft = (std::max(tx * RENDER_DIRTY_TILE, left) - entry->dest.x) / 16;
+							const int cellRight = (std::min((tx + 1) * RENDER_DIRTY_TILE, right) - 1 - entry->dest.x) / 16;
+							const int cellTop = (std::max(ty * RENDER_DIRTY_TILE, top) - entry->dest.y) / 16;
+							const int cellBottom = (std::min((ty + 1) * RENDER_DIRTY_TILE, bottom) - 1 - entry->dest.y) / 16;
+							
+							for (int cy = cellTop; cy <= cellBottom; cy++)
+								for (int cx = cellLeft; cx <= cellRight; cx++)
+									hash = MixHash(hash, entry->tilemap.cell[cy * entry->tilemap.width + cx]);
+						}
+						
+						tileHash[ty * tilesX + tx] = hash;
+					}
+				}
+			}
+		}
+	}
+	
+	//Find the tiles that have changed since our last frame, merging runs of them along each row of tiles
+	dirtyRect.clear();
+	dirtyTop = height;
+	dirtyBottom = 0;
+	dirtyPixels = 0;
+	
+	for (int ty = 0; ty < tilesY; ty++)
+	{
+		const size_t row = ty * tilesX;
+		
+		for (int tx = 0; tx < tilesX; tx++)
+		{
+			if (lastTileValid && tileHash[row + tx] == lastTileHash[row + tx])
+				continue;
+			
+			//Extend our run across every changed tile after this one
+			const int runStart = tx;
+			while (tx + 1 < tilesX && !(lastTileValid && tileHash[row + tx + 1] == lastTileHash[row + tx + 1]))
+				tx++;
+			
+			RECT rect;
+			rect.x = runStart * RENDER_DIRTY_TILE;
+			rect.y = ty * RENDER_DIRTY_TILE;
+			rect.w = std::min((tx + 1) * RENDER_DIRTY_TILE, width) - rect.x;
+			rect.h = std::min((ty + 1) * RENDER_DIRTY_TILE, height) - rect.y;
+			dirtyRect.push_back(rect);
+			
+			dirtyTop = std::min(dirtyTop, rect.y);
+			dirtyBottom = std::max(dirtyBottom, rect.y + rect.h);
+			dirtyPixels += rect.w * rect.h;
+		}
+	}
+	
+	if (dirtyTop > dirtyBottom)
+		dirtyTop = dirtyBottom = 0;
+	
+	//Keep our hashes to compare the next frame against
+	tileHash.swap(lastTileHash);
+	lastTileValid = true;
+}
+
+void SOFTWAREBUFFER::OutputDirty(void *outBuffer, const int outPitch)
+{
+	//Copy the area covered by our dirty rects from our back buffer (our output buffer starts at the area's top-left)
+	const size_t backPitch = width * gPixelFormat.bytesPerPixel;
+	const size_t rowSize = gOutputDirty.w * gPixelFormat.bytesPerPixel;
+	const uint8_t *backRow = backBuffer + (gOutputDirty.y * backPitch + gOutputDirty.x * gPixelFormat.bytesPerPixel);
+	
+	for (int y = 0; y < gOutputDirty.h; y++)
+		memcpy((uint8_t*)outBuffer + y * outPitch, backRow + y * backPitch, rowSize);
+}
+
+size_t SOFTWAREBUFFER::GetBands()
+{
+	//Don't split our buffer if we only have one thread
+	if (workers->GetThreads() <= 1)
+		return 1;
+	
+	//Get how many bands to split our buffer into
+	size_t bands = workers->GetThreads() * RENDER_BANDS_PER_THREAD;
+	size_t maxBands = (height + RENDER_MIN_BAND_HEIGHT - 1) / RENDER_MIN_BAND_HEIGHT;
+	return bands < maxBands ? bands : maxBands;
+}
+
+void SOFTWAREBUFFER::RunBands(void (*function)(void *data, size_t band), void *data, size_t bands)
+{
+	//Run each band across our worker pool
+	workers->Run(function, data, bands);
 }
 
 //Primary render function
 bool SOFTWAREBUFFER::RenderToScreen(const COLOUR *backgroundColour)
 {
+	//If tracking dirty rectangles, redraw what's changed into our back buffer, and only output the rows that covers
+	if (trackDirty)
+	{
+		BenchBeginPhase(BENCHPHASE_BLITQUEUE);
+		FindDirty(backgroundColour);
+		
+		switch (gPixelFormat.bytesPerPixel)
+		{
+			case 1:
+				BlitDirty<uint8_t>(backgroundColour);
+				break;
+			case 2:
+				BlitDirty<uint16_t>(backgroundColour);
+				break;
+		#ifdef uint24_t
+			case 3:
+				BlitDirty<uint24_t>(backgroundColour);
+				break;
+		#endif
+			case 4:
+				BlitDirty<uint32_t>(backgroundColour);
+				break;
+			default:
+				return Error("Unsupported BPP");
+		}
+		
+		BenchEndPhase(BENCHPHASE_BLITQUEUE);
+		gOutputDirty = {0, dirtyTop, width, dirtyBottom - dirtyTop};
+	}
+	else
+	{
+		gOutputDirty = {0, 0, width, height};
+	}
+	
 	//Get our buffer to render to
 	void *outBuffer;
 	int outPitch;
 	if (Backend_GetOutputBuffer(&outBuffer, &outPitch))
 		return true;
 	
-	if (outBuffer != nullptr)
+	if (outBuffer != nullptr && trackDirty)
+	{
+		//Copy our redrawn rows
+		OutputDirty(outBuffer, outPitch);
+	}
+	else if (outBuffer != nullptr)
 	{
 		//Render to our buffer
+		BenchBeginPhase(BENCHPHASE_BLITQUEUE);
+		
 		switch (gPixelFormat.bytesPerPixel)
 		{
 			case 1:
@@ -342,15 +646,25 @@ bool SOFTWAREBUFFER::RenderToScreen(const COLOUR *backgroundColour)
 			default:
 				return Error("Unsupported BPP");
 		}
+		
+		BenchEndPhase(BENCHPHASE_BLITQUEUE);
 	}
 	
 	//Clear all layers
 	for (size_t i = 0; i < RENDERLAYERS; i++)
-		queue[i].clear();
+		queue[i].Clear();
 	
 	//Render buffer to output
 	if (Backend_OutputBuffer())
 		return true;
+	
+	//Count this frame towards our benchmark
+	if (gBench.enabled)
+	{
+		if (trackDirty)
+			BenchCountPixels(dirtyPixels, width * height);
+		BenchEndFrame();
+	}
 	return false;
 }
 
@@ -366,9 +680,13 @@ bool InitializeRender()
 	
 	//Set our format globals
 	gPixelFormat = backendRenderFormat.pixelFormat;
+	gRefreshRate = backendRenderFormat.refreshRate;
+	
+	//Pick our span blitters
+	InitializeSpanBlitters();
 	
 	//Create our software buffer
-	gSoftwareBuffer = new SOFTWAREBUFFER(gRenderSpec.width, gRenderSpec.height);
+	gSoftwareBuffer = new SOFTWAREBUFFER(gRenderSpec.width, gRenderSpec.height, gRenderSpec.dirtyRects);
 	if (gSoftwareBuffer->fail)
 		return Error(gSoftwareBuffer->fail);
 	
@@ -384,5 +702,8 @@ void QuitRender()
 	if (gSoftwareBuffer)
 		delete gSoftwareBuffer;
 	
+	//Quit backend rendering
+	Backend_QuitRender();
+	
 	LOG(("Success!\n"));
 }
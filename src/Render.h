@@ -1,7 +1,10 @@
 #pragma once
 #include <string>
+#include <stddef.h>
+#include <type_traits>
+#include <vector>
 #include <stdint.h>
-#include "LinkedList.h"
+#include "FrameArena.h"
 
 //Rect and point structures
 struct RECT { int x, y, w, h; };
@@ -45,7 +48,9 @@ class PIXELFORMAT
 
 extern PIXELFORMAT gPixelFormat;
 
-//Palette and colours
+//Palette and colours (palette generations come from one shared counter, so a generation also tells palettes apart)
+extern unsigned int gPaletteGeneration;
+
 class COLOUR
 {
 	public:
@@ -86,6 +91,11 @@ class PALETTE
 		size_t colours;				//How many colours in the array
 		COLOUR *colour = nullptr;	//The actual colours
 		
+		//Flat, cache-aligned table of our native colours for the blitters (only rebuilt when our colours have changed)
+		alignas(0x40) mutable uint32_t native[0x100] = {};
+		mutable unsigned int nativeGeneration = ~0U;
+		unsigned int generation = ++gPaletteGeneration;	//Changed whenever our colours are changed
+		
 	public:
 		//Constructors
 		PALETTE(const size_t setColours) //Allocated undefined array of setColours length
@@ -122,6 +132,35 @@ class PALETTE
 			//Free colour array
 			delete[] colour;
 		}
+		
+		//Colour modification (anything that modifies our colour array directly must call MarkDirty)
+		inline void MarkDirty() { generation = ++gPaletteGeneration; }
+		
+		inline void SetColour(const size_t index, const bool setMod, const bool setOrig, const bool doRegen, const uint8_t setR, const uint8_t setG, const uint8_t setB)
+		{
+			colour[index].SetColour(setMod, setOrig, doRegen, setR, setG, setB);
+			MarkDirty();
+		}
+		
+		inline void Regen(const size_t index, const uint8_t setR, const uint8_t setG, const uint8_t setB)
+		{
+			colour[index].Regen(setR, setG, setB);
+			MarkDirty();
+		}
+		
+		//Get our native colour table
+		inline const uint32_t *GetNative() const
+		{
+			//Copy our colours into the table if they've changed since it was last built
+			if (nativeGeneration != generation)
+			{
+				const size_t copyColours = colours < 0x100 ? colours : 0x100;
+				for (size_t i = 0; i < copyColours; i++)
+					native[i] = colour[i].colour;
+				nativeGeneration = generation;
+			}
+			return native;
+		}
 };
 
 //Texture class
@@ -134,17 +173,26 @@ class TEXTURE
 		//Source file (if applicable)
 		std::string source;
 		
+		//Unique to this texture (so a texture loaded where a freed one used to be isn't mistaken for it)
+		unsigned int id;
+		
 		//Texture data
 		uint8_t *texture = nullptr;
 		int width;
 		int height;
 		
+		//Opacity (rows with no transparent (index 0) pixels can be drawn with the opaque blitters)
+		bool *rowOpaque = nullptr;
+		bool opaque = false;
+		
 		//Loaded palette
 		PALETTE *loadedPalette;
 		
 	public:
 		TEXTURE(std::string path);
 		~TEXTURE();
+		
+		void FindOpaqueRows();
 };
 
 //Render queue structure
@@ -154,8 +202,15 @@ enum RENDERQUEUE_TYPE
 {
 	RENDERQUEUE_TEXTURE,
 	RENDERQUEUE_SOLID,
+	RENDERQUEUE_TILEMAP,
 };
 
+//Tilemap cell format (16x16 tiles, the tile index is the tile's row in the texture)
+#define TILEMAP_CELL_TILE	0x03FF
+#define TILEMAP_CELL_XFLIP	0x0400
+#define TILEMAP_CELL_YFLIP	0x0800
+#define TILEMAP_CELL_EMPTY	0x8000
+
 struct RENDERQUEUE
 {
 	//Shared
@@ -176,9 +231,67 @@ struct RENDERQUEUE
 		{
 			const COLOUR *colour;
 		} solid;
+		struct
+		{
+			const uint16_t *cell;
+			const PALETTE *palette;
+			const TEXTURE *texture;
+			int width, height;	//Size of the map in cells
+			int srcX;			//Column of the texture to source tiles from
+		} tilemap;
 	};
 };
 
+//Render queue layer (contiguous blocks of entries allocated from the frame arena)
+#define RENDERQUEUE_BLOCK_ENTRIES 0x40
+
+struct RENDERQUEUE_BLOCK
+{
+	RENDERQUEUE_BLOCK *next;	//The block submitted before us
+	size_t size;				//How many entries are in this block
+	RENDERQUEUE entry[RENDERQUEUE_BLOCK_ENTRIES];
+};
+
+class RENDERQUEUE_LAYER
+{
+	public:
+		//Newest block
+		RENDERQUEUE_BLOCK *head = nullptr;
+		
+	public:
+		//Entry submission
+		void NewBlock();
+		
+		inline void Push(const RENDERQUEUE &push)
+		{
+			//Allocate a new block if full, then copy the entry to the end
+			if (head == nullptr || head->size >= RENDERQUEUE_BLOCK_ENTRIES)
+				NewBlock();
+			head->entry[head->size++] = push;
+		}
+		
+		//Clear (the blocks themselves are freed when the frame arena is reset)
+		inline void Clear() { head = nullptr; }
+};
+
+//Vectorised span blitters for 32-bit buffers (8-bit indices to native colours, picked according to what the CPU supports)
+#define SPANBLITTER_MIN_WIDTH 0x10	//Spans narrower than this are drawn by the inlined scalar blitter
+
+typedef void (*SPANBLITTER)(uint32_t *dstBuffer, const uint8_t *srcBuffer, const int w, const uint32_t *native);
+extern SPANBLITTER gSpanBlitter[2][2];	//[xFlip][hasTransparency]
+
+void InitializeSpanBlitters();
+
+//Dirty rectangle tracking
+#define RENDER_DIRTY_TILE 16	//Size of the tiles the buffer is compared in
+
+//Multithreaded rasterization (the buffer is split into horizontal bands, which are rasterized in parallel)
+#define RENDER_MAX_THREADS		0x10	//Most threads to rasterize with
+#define RENDER_BANDS_PER_THREAD	2		//How many bands to split the buffer into per thread (so faster threads can pick up more)
+#define RENDER_MIN_BAND_HEIGHT	8		//Smallest band to split the buffer into
+
+class WORKERPOOL;
+
 //Software framebuffer class
 class SOFTWAREBUFFER
 {
@@ -187,110 +300,343 @@ class SOFTWAREBUFFER
 		const char *fail = nullptr;
 		
 		//Render queue
-		LINKEDLIST<RENDERQUEUE> queue[RENDERLAYERS];
+		RENDERQUEUE_LAYER queue[RENDERLAYERS];
 		
 		//Dimensions of buffer
 		int width;
 		int height;
 		
+		//Worker pool to rasterize with
+		WORKERPOOL *workers = nullptr;
+		
+		//Dirty rectangle tracking (only the tiles whose draw commands changed since our last frame are redrawn, into our back buffer)
+		bool trackDirty = false;
+		uint8_t *backBuffer = nullptr;		//Our last frame, kept in the output pixel format
+		int tilesX = 0, tilesY = 0;
+		std::vector<uint64_t> tileHash;		//Hash of the draw commands covering each tile this frame
+		std::vector<uint64_t> lastTileHash;	//... and last frame
+		bool lastTileValid = false;			//If we have a last frame to compare against
+		
+		std::vector<RECT> dirtyRect;		//Runs of changed tiles to redraw (one per run along a row of tiles)
+		int dirtyTop = 0, dirtyBottom = 0;	//Rows covered by our dirty rects
+		size_t dirtyPixels = 0;				//Pixels covered by our dirty rects
+		
 	public:
-		SOFTWAREBUFFER(int bufWidth, int bufHeight);
+		SOFTWAREBUFFER(int bufWidth, int bufHeight, bool setTrackDirty);
+		~SOFTWAREBUFFER();
 		
 		void DrawPoint(const int layer, const POINT *point, const COLOUR *colour);
 		void DrawQuad(const int layer, const RECT *quad, const COLOUR *colour);
 		void DrawTexture(TEXTURE *texture, PALETTE *palette, const RECT *src, const int layer, const int x, const int y, const bool xFlip, const bool yFlip);
+		void DrawTilemap(TEXTURE *texture, PALETTE *palette, const uint16_t *cell, const int mapWidth, const int mapHeight, const int srcX, const int layer, const int x, const int y);
 		
 		bool RenderToScreen(const COLOUR *backgroundColour);
 		
-		//Blit function
-		template <typename T> inline void BlitQueue(const COLOUR *backgroundColour, T *buffer, const int pitch)
+		//Rasterization functions
+		void PrepareQueue();
+		void FindDirty(const COLOUR *backgroundColour);
+		void OutputDirty(void *outBuffer, const int outPitch);
+		size_t GetBands();
+		void RunBands(void (*function)(void *data, size_t band), void *data, size_t bands);
+		
+		//Span blit function
+		template <typename T, bool xFlip, bool hasTransparency> static inline void BlitSpan(T *dstBuffer, const uint8_t *srcBuffer, const int w, const uint32_t *native)
 		{
-			//Clear to the given background colour
+			//Use the vectorised blitter for long enough spans into 32-bit buffers
+			if (std::is_same<T, uint32_t>::value && w >= SPANBLITTER_MIN_WIDTH)
+			{
+				gSpanBlitter[xFlip][hasTransparency]((uint32_t*)dstBuffer, srcBuffer, w, native);
+				return;
+			}
+			
+			//Draw each pixel (skipping transparent ones if we have any), reading backwards if horizontally flipped
+			for (int x = 0; x < w; x++)
+			{
+				const uint8_t index = xFlip ? srcBuffer[-x] : srcBuffer[x];
+				if (!hasTransparency || index)
+					dstBuffer[x] = native[index];
+			}
+		}
+		
+		//Texture blit functions
+		template <typename T, bool xFlip, bool yFlip, bool hasTransparency> inline void BlitTextureRows(const RENDERQUEUE *entry, T *buffer, const int pitch)
+		{
+			const TEXTURE *texture = entry->texture.texture;
+			const uint32_t *native = entry->texture.palette->GetNative();
+			
+			//Get our starting row and the first pixel to read from it (bottom row if vertically flipped, right side if horizontally flipped)
+			int srcY = entry->texture.srcY + (yFlip ? (entry->dest.h - 1) : 0);
+			const int srcX = entry->texture.srcX + (xFlip ? (entry->dest.w - 1) : 0);
+			
+			T *dstBuffer = buffer + (entry->dest.x + entry->dest.y * pitch);
+			
+			//Draw each row
+			for (int y = 0; y < entry->dest.h; y++)
+			{
+				const uint8_t *srcBuffer = texture->texture + srcY * texture->width + srcX;
+				
+				//Rows known to be fully opaque can skip the transparency check
+				if (hasTransparency && !texture->rowOpaque[srcY])
+					BlitSpan<T, xFlip, true>(dstBuffer, srcBuffer, entry->dest.w, native);
+				else
+					BlitSpan<T, xFlip, false>(dstBuffer, srcBuffer, entry->dest.w, native);
+				
+				srcY += yFlip ? -1 : 1;
+				dstBuffer += pitch;
+			}
+		}
+		
+		template <typename T, bool hasTransparency> inline void BlitTextureFlip(const RENDERQUEUE *entry, T *buffer, const int pitch)
+		{
+			//Use the variant for our flip combination
+			if (entry->texture.xFlip)
+			{
+				if (entry->texture.yFlip)
+					BlitTextureRows<T, true, true, hasTransparency>(entry, buffer, pitch);
+				else
+					BlitTextureRows<T, true, false, hasTransparency>(entry, buffer, pitch);
+			}
+			else
+			{
+				if (entry->texture.yFlip)
+					BlitTextureRows<T, false, true, hasTransparency>(entry, buffer, pitch);
+				else
+					BlitTextureRows<T, false, false, hasTransparency>(entry, buffer, pitch);
+			}
+		}
+		
+		template <typename T> inline void BlitTexture(const RENDERQUEUE *entry, T *buffer, const int pitch)
+		{
+			//Don't draw clipped-away textures
+			if (entry->dest.w <= 0 || entry->dest.h <= 0)
+				return;
+			
+			//Use the opaque variants if the texture has no transparent pixels at all
+			if (entry->texture.texture->opaque)
+				BlitTextureFlip<T, false>(entry, buffer, pitch);
+			else
+				BlitTextureFlip<T, true>(entry, buffer, pitch);
+		}
+		
+		//Tilemap blit function
+		template <typename T> inline void BlitTilemap(const RENDERQUEUE *entry, T *buffer, const int pitch, const RECT &clip)
+		{
+			//Get the area of the tilemap in our clip rect
+			const int left = entry->dest.x < clip.x ? clip.x : entry->dest.x;
+			const int top = entry->dest.y < clip.y ? clip.y : entry->dest.y;
+			const int right = (entry->dest.x + entry->dest.w) > (clip.x + clip.w) ? (clip.x + clip.w) : (entry->dest.x + entry->dest.w);
+			const int bottom = (entry->dest.y + entry->dest.h) > (clip.y + clip.h) ? (clip.y + clip.h) : (entry->dest.y + entry->dest.h);
+			
+			const int texWidth = entry->tilemap.texture->width;
+			const uint8_t *srcTexture = entry->tilemap.texture->texture + entry->tilemap.srcX;
+			const uint32_t *native = entry->tilemap.palette->GetNative();
+			
+			//Draw each scanline
+			for (int y = top; y < bottom; y++)
+			{
+				//Get the row of cells and the line within them we're on
+				const int mapY = y - entry->dest.y;
+				const uint16_t *cellRow = entry->tilemap.cell + (mapY / 16) * entry->tilemap.width;
+				const int line = mapY % 16;
+				
+				T *dstBuffer = buffer + y * pitch;
+				
+				for (int x = left; x < right;)
+				{
+					//Get the cell we're in and how much of it is on-screen
+					const int mapX = x - entry->dest.x;
+					const int column = mapX % 16;
+					
+					int spanW = 16 - column;
+					if (x + spanW > right)
+						spanW = right - x;
+					
+					const uint16_t cell = cellRow[mapX / 16];
+					if (!(cell & TILEMAP_CELL_EMPTY))
+					{
+						//Get the line of the tile to draw (vertical flip just picks a different line), then draw using the appropriate horizontal flip variant
+						const int srcLine = (cell & TILEMAP_CELL_TILE) * 16 + ((cell & TILEMAP_CELL_YFLIP) ? (15 - line) : line);
+						const uint8_t *srcBuffer = srcTexture + srcLine * texWidth;
+						
+						if (entry->tilemap.texture->rowOpaque[srcLine])
+						{
+							if (cell & TILEMAP_CELL_XFLIP)
+								BlitSpan<T, true, false>(dstBuffer + x, srcBuffer + (15 - column), spanW, native);
+							else
+								BlitSpan<T, false, false>(dstBuffer + x, srcBuffer + column, spanW, native);
+						}
+						else
+						{
+							if (cell & TILEMAP_CELL_XFLIP)
+								BlitSpan<T, true, true>(dstBuffer + x, srcBuffer + (15 - column), spanW, native);
+							else
+								BlitSpan<T, false, true>(dstBuffer + x, srcBuffer + column, spanW, native);
+						}
+					}
+					
+					x += spanW;
+				}
+			}
+		}
+		
+		//Band blit functions
+		static inline bool ClipToRect(RENDERQUEUE *entry, const RECT &clip)
+		{
+			//Clip left
+			int dx = clip.x - entry->dest.x;
+			if (dx > 0)
+			{
+				if (entry->type == RENDERQUEUE_TEXTURE && !entry->texture.xFlip)
+					entry->texture.srcX += dx;
+				entry->dest.x += dx;
+				entry->dest.w -= dx;
+			}
+			
+			//Clip right
+			dx = entry->dest.x + entry->dest.w - (clip.x + clip.w);
+			if (dx > 0)
+			{
+				if (entry->type == RENDERQUEUE_TEXTURE && entry->texture.xFlip)
+					entry->texture.srcX += dx;
+				entry->dest.w -= dx;
+			}
+			
+			//Clip top
+			int dy = clip.y - entry->dest.y;
+			if (dy > 0)
+			{
+				if (entry->type == RENDERQUEUE_TEXTURE && !entry->texture.yFlip)
+					entry->texture.srcY += dy;
+				entry->dest.y += dy;
+				entry->dest.h -= dy;
+			}
+			
+			//Clip bottom
+			dy = entry->dest.y + entry->dest.h - (clip.y + clip.h);
+			if (dy > 0)
+			{
+				if (entry->type == RENDERQUEUE_TEXTURE && entry->texture.yFlip)
+					entry->texture.srcY += dy;
+				entry->dest.h -= dy;
+			}
+			
+			return entry->dest.w > 0 && entry->dest.h > 0;
+		}
+		
+		template <typename T> inline void BlitQueueRect(const COLOUR *backgroundColour, T *buffer, const int pitch, const RECT &clip)
+		{
+			//Clear our rect to the given background colour
 			if (backgroundColour != nullptr)
 			{
-				T *clrBuffer = buffer;
-				for (int i = 0; i < pitch * height; i++)
-					*clrBuffer++ = backgroundColour->colour;
+				T *clrBuffer = buffer + (clip.x + clip.y * pitch);
+				for (int y = 0; y < clip.h; y++)
+				{
+					for (int x = 0; x < clip.w; x++)
+						clrBuffer[x] = backgroundColour->colour;
+					clrBuffer += pitch;
+				}
 			}
 			
 			//Iterate through each layer
 			for (int i = RENDERLAYERS - 1; i >= 0; i--)
 			{
-				//Iterate through each entry
-				for (size_t v = 0; v < queue[i].size(); v++)
+				//Iterate through each block (newest first)
+				for (RENDERQUEUE_BLOCK *block = queue[i].head; block != nullptr; block = block->next)
 				{
-					RENDERQUEUE entry = queue[i][v];
-					
-					switch (entry.type)
+					//Iterate through each entry (newest first, later submissions are drawn underneath earlier ones)
+					for (size_t v = block->size; v-- > 0;)
 					{
-						case RENDERQUEUE_TEXTURE:
+						RENDERQUEUE entry = block->entry[v];
+						
+						switch (entry.type)
 						{
-							uint8_t *srcBuffer = entry.texture.texture->texture;
-							T *dstBuffer = buffer + (entry.dest.x + entry.dest.y * pitch);
-							
-							//Get how to render the texture according to our x and y flipping
-							const int finc = -(entry.texture.xFlip << 1) + 1;
-							int fpitch;
-							
-							//Vertical flip
-							if (entry.texture.yFlip)
+							case RENDERQUEUE_TEXTURE:
 							{
-								//Start at bottom and move upwards
-								srcBuffer += entry.texture.srcX + entry.texture.texture->width * (entry.texture.srcY + (entry.dest.h - 1));
-								fpitch = -(entry.texture.texture->width + entry.dest.w);
+								//Draw the part in our rect using the blitter variant for our flip and transparency
+								if (ClipToRect(&entry, clip))
+									BlitTexture<T>(&entry, buffer, pitch);
+								break;
 							}
-							else
-							{
-								//Move downwards
-								srcBuffer += (entry.texture.srcX + entry.texture.srcY * entry.texture.texture->width);
-								fpitch = entry.texture.texture->width - entry.dest.w;
-							}
-							
-							//Horizontal flip
-							if (entry.texture.xFlip)
-							{
-								//Start at right side
-								srcBuffer += entry.dest.w - 1;
-								fpitch += entry.dest.w * 2;
-							}
-							
-							//Iterate through each pixel
-							while (entry.dest.h-- > 0)
+							case RENDERQUEUE_SOLID:
 							{
-								for (int x = 0; x < entry.dest.w; x++)
+								//Clip to our rect
+								if (!ClipToRect(&entry, clip))
+									break;
+								
+								//Iterate through each pixel
+								T *dstBuffer = buffer + (entry.dest.x + entry.dest.y * pitch);
+								
+								while (entry.dest.h-- > 0)
 								{
-									if (*srcBuffer)
-										*dstBuffer = entry.texture.palette->colour[*srcBuffer].colour;
-									srcBuffer += finc;
-									dstBuffer++;
+									for (int x = 0; x < entry.dest.w; x++)
+										*dstBuffer++ = entry.solid.colour->colour;
+									dstBuffer += pitch - entry.dest.w;
 								}
-								
-								srcBuffer += fpitch;
-								dstBuffer += pitch - entry.dest.w;
+								break;
 							}
-							break;
-						}
-						case RENDERQUEUE_SOLID:
-						{
-							//Iterate through each pixel
-							T *dstBuffer = buffer + (entry.dest.x + entry.dest.y * pitch);
-							
-							while (entry.dest.h-- > 0)
+							case RENDERQUEUE_TILEMAP:
 							{
-								for (int x = 0; x < entry.dest.w; x++)
-									*dstBuffer++ = entry.solid.colour->colour;
-								dstBuffer += pitch - entry.dest.w;
+								//Rasterize the tilemap's scanlines in our rect
+								BlitTilemap<T>(&entry, buffer, pitch, clip);
+								break;
+							}
+							default:
+							{
+								break;
 							}
-							break;
-						}
-						default:
-						{
-							break;
 						}
 					}
 				}
 			}
 		}
+		
+		template <typename T> struct BLITBAND_JOB
+		{
+			SOFTWAREBUFFER *softwareBuffer;
+			const COLOUR *backgroundColour;
+			T *buffer;
+			int pitch;
+			int bandHeight;
+		};
+		
+		template <typename T> static void BlitBandJob(void *data, size_t band)
+		{
+			//Get the rows of our band and rasterize them
+			BLITBAND_JOB<T> *job = (BLITBAND_JOB<T>*)data;
+			const int top = (int)band * job->bandHeight;
+			const int bottom = (top + job->bandHeight) > job->softwareBuffer->height ? job->softwareBuffer->height : (top + job->bandHeight);
+			job->softwareBuffer->template BlitQueueRect<T>(job->backgroundColour, job->buffer, job->pitch, {0, top, job->softwareBuffer->width, bottom - top});
+		}
+		
+		template <typename T> static void BlitDirtyJob(void *data, size_t rect)
+		{
+			//Rasterize our dirty rect
+			BLITBAND_JOB<T> *job = (BLITBAND_JOB<T>*)data;
+			job->softwareBuffer->template BlitQueueRect<T>(job->backgroundColour, job->buffer, job->pitch, job->softwareBuffer->dirtyRect[rect]);
+		}
+		
+		//Blit functions
+		template <typename T> inline void BlitQueue(const COLOUR *backgroundColour, T *buffer, const int pitch)
+		{
+			//Get everything ready for the bands to read in parallel
+			PrepareQueue();
+			
+			//Split our buffer into horizontal bands, and rasterize them across our worker pool
+			const size_t bands = GetBands();
+			BLITBAND_JOB<T> job = {this, backgroundColour, buffer, pitch, (int)((height + bands - 1) / bands)};
+			RunBands(&BlitBandJob<T>, &job, bands);
+		}
+		
+		template <typename T> inline void BlitDirty(const COLOUR *backgroundColour)
+		{
+			//Get everything ready for the rects to read in parallel
+			PrepareQueue();
+			
+			//Rasterize each dirty rect into our back buffer across our worker pool (they never overlap)
+			BLITBAND_JOB<T> job = {this, backgroundColour, (T*)backBuffer, width, 0};
+			if (!dirtyRect.empty())
+				RunBands(&BlitDirtyJob<T>, &job, dirtyRect.size());
+		}
 
 };
 
@@ -303,12 +649,27 @@ struct RENDERSPEC
 	//Framerate and vsync
 	double framerate;
 	bool forceVsync, forceVsyncValue;
+	
+	//Only redraw and output what's changed since the last frame
+	bool dirtyRects;
+};
+
+//How the backend paces our presented frames
+enum RENDERPACING
+{
+	RENDERPACING_FRAMERATE,	//Wait for our framerate after every frame (one update per frame)
+	RENDERPACING_REFRESH,	//Present once per display refresh (the game mode steps its own simulation)
 };
 
 //Globals
 extern RENDERSPEC gRenderSpec;
 extern SOFTWAREBUFFER *gSoftwareBuffer;
 
+extern double gRefreshRate;
+extern RENDERPACING gRenderPacing;
+
+extern RECT gOutputDirty;	//Area of the output buffer drawn to this frame (the backend's buffer starts at its top-left, and only this has to be uploaded)
+
 //Sub-system functions
 bool InitializeRender();
 void QuitRender();
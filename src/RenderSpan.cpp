@@ -0,0 +1,120 @@
+#include "Render.h"
+#include "Log.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define SPANBLITTER_X86
+#endif
+
+//Scalar span blitter (also used for the ends of the vectorised spans)
+template <bool xFlip, bool hasTransparency> static void SpanScalar(uint32_t *dstBuffer, const uint8_t *srcBuffer, const int w, const uint32_t *native)
+{
+	for (int x = 0; x < w; x++)
+	{
+		const uint8_t index = xFlip ? srcBuffer[-x] : srcBuffer[x];
+		if (!hasTransparency || index)
+			dstBuffer[x] = native[index];
+	}
+}
+
+#ifdef SPANBLITTER_X86
+//SSE2 span blitter (4 pixels at a time, looked up individually then blended with the destination by an index 0 mask)
+template <bool xFlip, bool hasTransparency> __attribute__((target("sse2"))) static void SpanSSE2(uint32_t *dstBuffer, const uint8_t *srcBuffer, const int w, const uint32_t *native)
+{
+	const __m128i zero = _mm_setzero_si128();
+	
+	int x = 0;
+	for (; x + 4 <= w; x += 4)
+	{
+		//Get our indices and look up their colours
+		const uint8_t i0 = xFlip ? srcBuffer[-x - 0] : srcBuffer[x + 0];
+		const uint8_t i1 = xFlip ? srcBuffer[-x - 1] : srcBuffer[x + 1];
+		const uint8_t i2 = xFlip ? srcBuffer[-x - 2] : srcBuffer[x + 2];
+		const uint8_t i3 = xFlip ? srcBuffer[-x - 3] : srcBuffer[x + 3];
+		__m128i colour = _mm_set_epi32(native[i3], native[i2], native[i1], native[i0]);
+		
+		//Keep the destination wherever our index is 0
+		if (hasTransparency)
+		{
+			const __m128i mask = _mm_cmpeq_epi32(_mm_set_epi32(i3, i2, i1, i0), zero);
+			const __m128i dst = _mm_loadu_si128((const __m128i*)(dstBuffer + x));
+			colour = _mm_or_si128(_mm_and_si128(mask, dst), _mm_andnot_si128(mask, colour));
+		}
+		
+		_mm_storeu_si128((__m128i*)(dstBuffer + x), colour);
+	}
+	
+	//Draw the remaining pixels
+	SpanScalar<xFlip, hasTransparency>(dstBuffer + x, srcBuffer + (xFlip ? -x : x), w - x, native);
+}
+
+//AVX2 span blitter (16 pixels at a time, gathered from the colour table then blended with the destination by an index 0 mask)
+template <bool xFlip, bool hasTransparency> __attribute__((target("avx2"))) static void SpanAVX2(uint32_t *dstBuffer, const uint8_t *srcBuffer, const int w, const uint32_t *native)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+	
+	int x = 0;
+	for (; x + 16 <= w; x += 16)
+	{
+		//Load our 16 indices (reversed if reading backwards)
+		__m128i index;
+		if (xFlip)
+			index = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(srcBuffer - x - 15)), reverse);
+		else
+			index = _mm_loadu_si128((const __m128i*)(srcBuffer + x));
+		
+		//Skip entirely transparent runs
+		if (hasTransparency && _mm_movemask_epi8(_mm_cmpeq_epi8(index, zero)) == 0xFFFF)
+			continue;
+		
+		//Widen our indices and gather their colours
+		const __m256i index0 = _mm256_cvtepu8_epi32(index);
+		const __m256i index1 = _mm256_cvtepu8_epi32(_mm_srli_si128(index, 8));
+		__m256i colour0 = _mm256_i32gather_epi32((const int*)native, index0, 4);
+		__m256i colour1 = _mm256_i32gather_epi32((const int*)native, index1, 4);
+		
+		//Keep the destination wherever our index is 0
+		if (hasTransparency)
+		{
+			const __m256i mask0 = _mm256_cmpeq_epi32(index0, _mm256_setzero_si256());
+			const __m256i mask1 = _mm256_cmpeq_epi32(index1, _mm256_setzero_si256());
+			colour0 = _mm256_blendv_epi8(colour0, _mm256_loadu_si256((const __m256i*)(dstBuffer + x + 0)), mask0);
+			colour1 = _mm256_blendv_epi8(colour1, _mm256_loadu_si256((const __m256i*)(dstBuffer + x + 8)), mask1);
+		}
+		
+		_mm256_storeu_si256((__m256i*)(dstBuffer + x + 0), colour0);
+		_mm256_storeu_si256((__m256i*)(dstBuffer + x + 8), colour1);
+	}
+	
+	//Draw the remaining pixels
+	SpanScalar<xFlip, hasTransparency>(dstBuffer + x, srcBuffer + (xFlip ? -x : x), w - x, native);
+}
+#endif
+
+//Span blitter table
+SPANBLITTER gSpanBlitter[2][2] = {
+	{SpanScalar<false, false>, SpanScalar<false, true>},
+	{SpanScalar<true, false>, SpanScalar<true, true>},
+};
+
+void InitializeSpanBlitters()
+{
+#ifdef SPANBLITTER_X86
+	//Use the best blitters our CPU supports
+	__builtin_cpu_init();
+	
+	if (__builtin_cpu_supports("avx2"))
+	{
+		LOG(("Using AVX2 span blitters... "));
+		gSpanBlitter[0][0] = SpanAVX2<false, false>; gSpanBlitter[0][1] = SpanAVX2<false, true>;
+		gSpanBlitter[1][0] = SpanAVX2<true, false>; gSpanBlitter[1][1] = SpanAVX2<true, true>;
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		LOG(("Using SSE2 span blitters... "));
+		gSpanBlitter[0][0] = SpanSSE2<false, false>; gSpanBlitter[0][1] = SpanSSE2<false, true>;
+		gSpanBlitter[1][0] = SpanSSE2<true, false>; gSpanBlitter[1][1] = SpanSSE2<true, true>;
+	}
+#endif
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include "RingManager.h"
+#include "Filesystem.h"
+#include "Level.h"
+#include "Game.h"
+#include "Objects.h"
+#include "Error.h"
+
+//Constructor
+RINGMANAGER::RINGMANAGER(std::string path)
+{
+	//Open our ring file
+	FS_FILE ringFile(path, "rb");
+	if (ringFile.fail != nullptr)
+	{
+		Error(fail = ringFile.fail);
+		return;
+	}
+	
+	//Read our ring groups and expand them into rings
+	std::vector<std::pair<int16_t, int16_t>> rings;
+	
+	int groups = ringFile.GetSize() / 4;
+	for (int i = 0; i < groups; i++)
+	{
+		int16_t groupX = ringFile.ReadBE16();
+		int16_t word2 = ringFile.ReadBE16();
+		if (groupX == -1)
+			break;
+		
+		int16_t groupY = word2 & 0x0FFF;
+		int type = (word2 & 0xF000) >> 12;
+		
+		for (int v = 0; v <= (type & 0x7); v++)
+		{
+			rings.push_back({groupX, groupY});
+			
+			//Offset next position
+			if (type & 0x8)
+				groupY += RINGMANAGER_SPACING;
+			else
+				groupX += RINGMANAGER_SPACING;
+		}
+	}
+	
+	//Sort our rings by X, so our window only has to move along its edges
+	std::stable_sort(rings.begin(), rings.end(), [](const std::pair<int16_t, int16_t> &a, const std::pair<int16_t, int16_t> &b) { return a.first < b.first; });
+	
+	xPos.resize(rings.size());
+	yPos.resize(rings.size());
+	collected.assign((rings.size() + 0x1F) >> 5, 0);
+	
+	for (size_t i = 0; i < rings.size(); i++)
+	{
+		xPos[i] = rings[i].first;
+		yPos[i] = rings[i].second;
+	}
+	
+	//Get our texture and mappings
+	texture = gLevel->GetObjectTexture("data/Object/Generic.bmp");
+	if (texture->fail != nullptr)
+	{
+		Error(fail = texture->fail);
+		return;
+	}
+	
+	mappings = gLevel->GetObjectMappings("data/Object/Ring.map");
+	if (mappings->fail != nullptr)
+	{
+		Error(fail = mappings->fail);
+		return;
+	}
+}
+
+//Window function
+void RINGMANAGER::UpdateWindow(int16_t cameraX)
+{
+	int left = cameraX - RINGMANAGER_WINDOW_LEFT;
+	int right = cameraX + gRenderSpec.width + RINGMANAGER_WINDOW_RIGHT;
+	
+	//Move our left edge
+	while (windowLeft < xPos.size() && xPos[windowLeft] < left)
+		windowLeft++;
+	while (windowLeft > 0 && xPos[windowLeft - 1] >= left)
+		windowLeft--;
+	
+	//Move our right edge
+	while (windowRight < xPos.size() && xPos[windowRight] < right)
+		windowRight++;
+	while (windowRight > 0 && xPos[windowRight - 1] >= right)
+		windowRight--;
+	
+	windowRight = std::max(windowRight, windowLeft);
+}
+
+//Player interaction functions
+void RINGMANAGER::Touch(PLAYER *player, int16_t playerLeft, int16_t playerTop, int16_t playerWidth, int16_t playerHeight)
+{
+	//Don't collect rings if we were just hit
+	if (player->invulnerabilityTime >= 90)
+		return;
+	
+	//Check every ring in our window that's horizontally in range of the player's hitbox
+	size_t i = std::lower_bound(xPos.begin() + windowLeft, xPos.begin() + windowRight, playerLeft - RINGMANAGER_TOUCH_RADIUS) - xPos.begin();
+	
+	for (; i < windowRight && xPos[i] - RINGMANAGER_TOUCH_RADIUS <= playerLeft + playerWidth; i++)
+	{
+		int16_t verticalCheck = playerTop - (yPos[i] - RINGMANAGER_TOUCH_RADIUS);
+		if (verticalCheck < -playerHeight || verticalCheck > RINGMANAGER_TOUCH_RADIUS * 2 || IsCollected(i))
+			continue;
+		
+		//Collect this ring and leave a sparkle behind
+		SetCollected(i);
+		sparkles.push_back({xPos[i], yPos[i], 0});
+		AddToRings(1);
+	}
+}
+
+void RINGMANAGER::Attract(PLAYER *player, int16_t radius)
+{
+	//Turn every ring in our window within range of the player into an attracted ring object
+	size_t i = std::lower_bound(xPos.begin() + windowLeft, xPos.begin() + windowRight, player->x.pos - radius) - xPos.begin();
+	
+	for (; i < windowRight && xPos[i] <= player->x.pos + radius; i++)
+	{
+		if (yPos[i] < player->y.pos - radius || yPos[i] > player->y.pos + radius || IsCollected(i))
+			continue;
+		
+		SetCollected(i);
+		
+		OBJECT *newObject = new OBJECT(&ObjAttractRing);
+		newObject->x.pos = xPos[i];
+		newObject->y.pos = yPos[i];
+		newObject->parentPlayer = player;
+		gLevel->objectList.link_back(newObject);
+	}
+}
+
+//Update and draw functions
+void RINGMANAGER::Update()
+{
+	//Advance our sparkles, and remove any that have finished
+	size_t keep = 0;
+	for (size_t i = 0; i < sparkles.size(); i++)
+	{
+		if (++sparkles[i].timer < RINGMANAGER_SPARKLE_SPEED * RINGMANAGER_SPARKLE_FRAMES)
+			sparkles[keep++] = sparkles[i];
+	}
+	sparkles.resize(keep);
+}
+
+void RINGMANAGER::Draw()
+{
+	int cameraX = gLevel->camera->drawXPos, cameraY = gLevel->camera->drawYPos;
+	
+	//Draw every uncollected ring in our window (all with the same spinning frame)
+	unsigned int mappingFrame = (gLevel->frameCounter >> 3) & 0x3;
+	if (mappingFrame < mappings->size)
+	{
+		RECT mapRect = mappings->rect[mappingFrame];
+		POINT mapOrig = mappings->origin[mappingFrame];
+		LEVEL_RENDERLAYER layer = gLevel->GetObjectLayer(false, 2);
+		
+		for (size_t i = windowLeft; i < windowRight; i++)
+		{
+			if (IsCollected(i) || yPos[i] - cameraY < -mapRect.h || yPos[i] - cameraY > gRenderSpec.height + mapRect.h)
+				continue;
+			gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, &mapRect, layer, xPos[i] - mapOrig.x - cameraX, yPos[i] - mapOrig.y - cameraY, false, false);
+		}
+	}
+	
+	//Draw our sparkles
+	LEVEL_RENDERLAYER layer = gLevel->GetObjectLayer(false, 1);
+	
+	for (size_t i = 0; i < sparkles.size(); i++)
+	{
+		unsigned int sparkleFrame = RINGMANAGER_SPARKLE_FRAME + sparkles[i].timer / RINGMANAGER_SPARKLE_SPEED;
+		if (sparkleFrame >= mappings->size)
+			continue;
+		
+		RECT mapRect = mappings->rect[sparkleFrame];
+		POINT mapOrig = mappings->origin[sparkleFrame];
+		gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, &mapRect, layer, sparkles[i].xPos - mapOrig.x - cameraX, sparkles[i].yPos - mapOrig.y - cameraY, false, false);
+	}
+}
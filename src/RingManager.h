@@ -0,0 +1,70 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Render.h"
+#include "Mappings.h"
+
+//Declare the player class
+class PLAYER;
+
+//Ring manager constants
+#define RINGMANAGER_SPACING			0x18	//Distance between the rings in a group
+#define RINGMANAGER_TOUCH_RADIUS	6		//Same as a ring object's touch width and height
+#define RINGMANAGER_WINDOW_LEFT		0x08	//How far left of the camera rings are active
+#define RINGMANAGER_WINDOW_RIGHT	0x18	//How far right of the screen rings are active
+#define RINGMANAGER_SPARKLE_FRAME	4		//First mapping frame of the sparkle animation
+#define RINGMANAGER_SPARKLE_SPEED	6		//Frames each sparkle mapping frame is shown for
+#define RINGMANAGER_SPARKLE_FRAMES	4		//Mapping frames in the sparkle animation
+
+//Ring manager class (the level's placed rings, stored as arrays sorted by X instead of as objects)
+class RINGMANAGER
+{
+	private:
+		//Collected ring sparkles
+		struct SPARKLE
+		{
+			int16_t xPos, yPos;
+			uint8_t timer;
+		};
+	
+	public:
+		//Failure
+		const char *fail = nullptr;
+		
+		//Our rings (sorted by X, collected rings are left in place with their bit set)
+		std::vector<int16_t> xPos;
+		std::vector<int16_t> yPos;
+		std::vector<uint32_t> collected;
+		
+		//The rings in range of the camera (xPos[windowLeft, windowRight))
+		size_t windowLeft = 0, windowRight = 0;
+		
+		//Sparkles of rings that have been collected
+		std::vector<SPARKLE> sparkles;
+		
+		//Our texture and mappings
+		TEXTURE *texture = nullptr;
+		MAPPINGS *mappings = nullptr;
+	
+	public:
+		//Constructor
+		RINGMANAGER(std::string path);
+		
+		//Collected bit functions
+		inline bool IsCollected(size_t i) const { return (collected[i >> 5] & (1 << (i & 0x1F))) != 0; }
+		inline void SetCollected(size_t i) { collected[i >> 5] |= (1 << (i & 0x1F)); }
+		
+		//Move our window to the given camera position
+		void UpdateWindow(int16_t cameraX);
+		
+		//Player interaction functions
+		void Touch(PLAYER *player, int16_t playerLeft, int16_t playerTop, int16_t playerWidth, int16_t playerHeight);
+		void Attract(PLAYER *player, int16_t radius);
+		
+		//Update and draw functions
+		void Update();
+		void Draw();
+};
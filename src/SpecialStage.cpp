@@ -211,6 +211,7 @@ void SPECIALSTAGE::RotatePalette()
 	const uint8_t *mapIndex = ssPalCycleMap + frame;
 	for (int i = 0; i < 0x20; i++)
 		stageTexture->loadedPalette->colour[1 + i] = (*mapIndex++) ? tile2 : tile1;
+	stageTexture->loadedPalette->MarkDirty();
 }
 
 void SPECIALSTAGE::UpdateStageFrame()
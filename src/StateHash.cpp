@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <string.h>
+#include <initializer_list>
+#include "StateHash.h"
+#include "Level.h"
+#include "Game.h"
+#include "Error.h"
+#include "Log.h"
+
+//State hash (set from the command line)
+STATEHASH *gStateHash = nullptr;
+
+//Trace file signature
+static const char *traceSign = "SHV01";
+
+//Flag packing
+static uint32_t PackFlags(std::initializer_list<bool> flags)
+{
+	uint32_t value = 0, bit = 1;
+	for (bool flag : flags)
+	{
+		if (flag)
+			value |= bit;
+		bit <<= 1;
+	}
+	return value;
+}
+
+//Constructor and destructor
+STATEHASH::STATEHASH(std::string path, bool setChecking)
+{
+	LOG(("%s state trace %s... ", setChecking ? "Loading" : "Creating", path.c_str()));
+	
+	//Open our trace file
+	checking = setChecking;
+	file = new FS_FILE(path, checking ? "rb" : "wb");
+	if (file->fail)
+	{
+		Error(fail = file->fail);
+		return;
+	}
+	
+	//Check or write our signature
+	if (checking)
+	{
+		char signature[0x10] = {};
+		file->Read(signature, 1, strlen(traceSign));
+		if (strncmp(signature, traceSign, strlen(traceSign)))
+		{
+			Error(fail = "Invalid state trace signature");
+			return;
+		}
+	}
+	else
+	{
+		file->Write(traceSign, 1, strlen(traceSign));
+	}
+	
+	LOG(("Success!\n"));
+}
+
+STATEHASH::~STATEHASH()
+{
+	//Close our trace file
+	delete file;
+}
+
+//Field gathering
+void STATEHASH::Gather(LEVEL *level)
+{
+	fields.clear();
+	
+	//Global state
+	Add(nullptr, -1, "frameCounter", level->frameCounter);
+	Add(nullptr, -1, "rings", gRings);
+	Add(nullptr, -1, "score", gScore);
+	Add(nullptr, -1, "time", gTime);
+	
+	for (int i = 0; i < OSCILLATORY_VALUES; i++)
+	{
+		Add("oscillate", i, "value", level->oscillate[i][0] | (level->oscillate[i][1] << 16));
+		Add("oscillate", i, "direction", level->oscillateDirection[i]);
+	}
+	
+	//Players
+	Add(nullptr, -1, "players", level->playerList.size());
+	
+	int index = 0;
+	for (LL_NODE<PLAYER*> *node = level->playerList.head; node != nullptr; node = node->next)
+	{
+		PLAYER *player = node->node_entry;
+		Add("player", index, "controlHeld", player->controlHeld.GetBits());
+		Add("player", index, "xLong", player->xLong);
+		Add("player", index, "yLong", player->yLong);
+		Add("player", index, "xVel", (uint16_t)player->xVel);
+		Add("player", index, "yVel", (uint16_t)player->yVel);
+		Add("player", index, "inertia", (uint16_t)player->inertia);
+		Add("player", index, "routine", player->routine);
+		Add("player", index, "angle", player->angle);
+		Add("player", index, "radius", player->xRadius | (player->yRadius << 8));
+		Add("player", index, "anim", player->anim | (player->animFrame << 8) | (player->mappingFrame << 16));
+		Add("player", index, "status", PackFlags({
+			player->status.xFlip,
+			player->status.inAir,
+			player->status.inBall,
+			player->status.shouldNotFall,
+			player->status.rollJumping,
+			player->status.pushing,
+			player->status.underwater,
+			player->status.jumping,
+			player->status.isSliding,
+			player->status.stickToConvex,
+			player->status.reverseGravity,
+			player->status.windTunnel,
+		}));
+		Add("player", index, "moveLock", player->moveLock);
+		Add("player", index, "jumpAbility", player->jumpAbility);
+		Add("player", index, "invulnerabilityTime", player->invulnerabilityTime);
+		Add("player", index, "spindashCounter", player->spindashCounter);
+		index++;
+	}
+	
+	//Objects
+	Add(nullptr, -1, "objects", level->objectList.size());
+	
+	index = 0;
+	for (size_t i = 0; i < level->objectList.size(); i++)
+	{
+		OBJECT *object = level->objectList[i];
+		Add("object", index, "subtype", object->subtype);
+		Add("object", index, "xLong", object->xLong);
+		Add("object", index, "yLong", object->yLong);
+		Add("object", index, "xVel", (uint16_t)object->xVel);
+		Add("object", index, "yVel", (uint16_t)object->yVel);
+		Add("object", index, "inertia", (uint16_t)object->inertia);
+		Add("object", index, "routine", object->routine | (object->routineSecondary << 8) | (object->angle << 16));
+		Add("object", index, "collision", object->collisionType | ((uint8_t)object->touchWidth << 8) | ((uint8_t)object->touchHeight << 16));
+		Add("object", index, "anim", object->anim | (object->animFrame << 8) | (object->mappingFrame << 16));
+		Add("object", index, "status", PackFlags({
+			object->status.xFlip,
+			object->status.yFlip,
+			object->status.releaseDestroyed,
+			object->status.noBalance,
+			object->status.objectSpecific,
+			object->deleteFlag,
+		}));
+		index++;
+	}
+}
+
+uint32_t STATEHASH::Hash()
+{
+	//FNV-1a over all of our values
+	uint32_t hash = 0x811C9DC5;
+	for (size_t i = 0; i < fields.size(); i++)
+	{
+		for (int v = 0; v < 32; v += 8)
+			hash = (hash ^ ((fields[i].value >> v) & 0xFF)) * 0x01000193;
+	}
+	return hash;
+}
+
+//Trace writing and checking
+void STATEHASH::Write(uint32_t hash)
+{
+	//Write our hash, followed by every value so a check can tell which one diverged
+	file->WriteLE32(hash);
+	file->WriteLE32(fields.size());
+	for (size_t i = 0; i < fields.size(); i++)
+		file->WriteLE32(fields[i].value);
+}
+
+void STATEHASH::Check(uint32_t hash)
+{
+	//Read the reference frame (stop checking once we've run past the end of the trace)
+	uint32_t referenceHash = file->ReadLE32();
+	uint32_t referenceFields = file->ReadLE32();
+	if (feof(file->fp))
+	{
+		printf("State trace ended on frame %u\n", frame);
+		stopped = true;
+		return;
+	}
+	
+	//If our hashes match, skip the reference values
+	if (referenceHash == hash && referenceFields == fields.size())
+	{
+		file->Seek(referenceFields * 4, SEEK_CUR);
+		return;
+	}
+	
+	//Find the first value that differs
+	reference.resize(referenceFields);
+	for (uint32_t i = 0; i < referenceFields; i++)
+		reference[i] = file->ReadLE32();
+	
+	diverged = stopped = true;
+	
+	for (size_t i = 0; i < fields.size() && i < reference.size(); i++)
+	{
+		if (fields[i].value == reference[i])
+			continue;
+		
+		if (fields[i].group != nullptr)
+			printf("State diverged on frame %u: %s[%d].%s (expected 0x%08X, got 0x%08X)\n", frame, fields[i].group, fields[i].index, fields[i].name, reference[i], fields[i].value);
+		else
+			printf("State diverged on frame %u: %s (expected 0x%08X, got 0x%08X)\n", frame, fields[i].name, reference[i], fields[i].value);
+		return;
+	}
+	
+	printf("State diverged on frame %u: field count (expected %u, got %u)\n", frame, referenceFields, (unsigned int)fields.size());
+}
+
+//Frame function
+void STATEHASH::Frame(LEVEL *level)
+{
+	if (stopped)
+		return;
+	
+	//Gather and hash our state, then write or check it
+	Gather(level);
+	uint32_t hash = Hash();
+	
+	if (checking)
+		Check(hash);
+	else
+		Write(hash);
+	
+	if (!stopped)
+		frame++;
+}
+
+//Report
+void STATEHASH::Report()
+{
+	//Divergence is reported as soon as it happens
+	if (diverged)
+		return;
+	
+	if (checking)
+		printf("State matched the trace for %u frames\n", frame);
+	else
+		printf("Wrote a state trace of %u frames\n", frame);
+}
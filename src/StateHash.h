@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Filesystem.h"
+
+//Declare the level class
+class LEVEL;
+
+//State hash field (a single value of the simulation state)
+struct STATEHASH_FIELD
+{
+	const char *group;	//What this value belongs to ("player", "object", "oscillate", or null if global)
+	int index;			//Which one of the group it belongs to
+	const char *name;	//What this value is
+	uint32_t value;
+};
+
+//State hash class (hashes the simulation state every frame, and either writes a trace of it or checks it against one)
+class STATEHASH
+{
+	public:
+		//Failure
+		const char *fail = nullptr;
+		
+		//Our trace file and mode
+		FS_FILE *file = nullptr;
+		bool checking = false;
+		
+		//Progress
+		unsigned int frame = 0;
+		bool diverged = false;
+		bool stopped = false;	//Set once we've diverged or run past the end of the trace
+		
+		//Current frame's fields (kept to avoid reallocating every frame)
+		std::vector<STATEHASH_FIELD> fields;
+		std::vector<uint32_t> reference;
+	
+	public:
+		//Constructor and destructor
+		STATEHASH(std::string path, bool setChecking);
+		~STATEHASH();
+		
+		//Hash the given level's state for this frame
+		void Frame(LEVEL *level);
+		
+		//Print the result of our check
+		void Report();
+	
+	private:
+		inline void Add(const char *group, int index, const char *name, uint32_t value) { fields.push_back({group, index, name, value}); }
+		void Gather(LEVEL *level);
+		uint32_t Hash();
+		
+		void Write(uint32_t hash);
+		void Check(uint32_t hash);
+};
+
+extern STATEHASH *gStateHash;
@@ -0,0 +1,48 @@
+#include <math.h>
+#include "Timestep.h"
+#include "MathUtil.h"
+
+//Constructor
+TIMESTEP::TIMESTEP(double stepRate, double refreshRate)
+{
+	//Get our step and refresh lengths
+	stepTime = 1.0 / stepRate;
+	refreshTime = (refreshRate != 0.0) ? (1.0 / refreshRate) : stepTime;
+}
+
+//Advance functions
+unsigned int TIMESTEP::Advance()
+{
+	//Get how long it's been since we last advanced (simulate a single step for our first frame)
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	double elapsed = started ? std::chrono::duration<double>(now - last).count() : stepTime;
+	last = now;
+	started = true;
+	
+	//Snap to a whole number of refreshes if we're close enough to one
+	double refreshes = floor(elapsed / refreshTime + 0.5);
+	if (refreshes >= 1.0 && fabs(elapsed - refreshes * refreshTime) < TIMESTEP_SNAP)
+		elapsed = refreshes * refreshTime;
+	
+	return Advance(elapsed);
+}
+
+unsigned int TIMESTEP::Advance(double elapsed)
+{
+	//Add to our accumulator, and take as many steps out of it as we can
+	accumulator += elapsed;
+	
+	unsigned int steps = (unsigned int)(accumulator / stepTime);
+	accumulator -= steps * stepTime;
+	
+	//If we've fallen too far behind, drop the time we can't catch up on
+	if (steps > TIMESTEP_MAX_STEPS)
+		steps = TIMESTEP_MAX_STEPS;
+	return steps;
+}
+
+//Get how far we are into our next step
+uint16_t TIMESTEP::GetAlpha() const
+{
+	return (uint16_t)mmin(mmax(accumulator / stepTime, 0.0) * 0x100, 0x100);
+}
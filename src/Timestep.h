@@ -0,0 +1,34 @@
+#pragma once
+#include <stdint.h>
+#include <chrono>
+
+//Timestep constants
+#define TIMESTEP_MAX_STEPS	4		//Most steps simulated for a single frame (if we fall further behind than this, we slow down instead of catching up)
+#define TIMESTEP_SNAP		0.0005	//Frame times within this many seconds of a whole number of refreshes are snapped to it (removes timer jitter under VSync)
+
+//Fixed timestep class (turns the time between presented frames into a fixed number of simulation steps)
+class TIMESTEP
+{
+	public:
+		//Our step and refresh lengths (in seconds)
+		double stepTime;
+		double refreshTime;
+		
+		//Time we've yet to simulate
+		double accumulator = 0.0;
+		
+		//When we last advanced
+		std::chrono::steady_clock::time_point last;
+		bool started = false;
+	
+	public:
+		//Constructor
+		TIMESTEP(double stepRate, double refreshRate);
+		
+		//Advance functions (return how many steps to simulate)
+		unsigned int Advance();
+		unsigned int Advance(double elapsed);
+		
+		//Get how far we are into our next step (0x100 being a full step)
+		uint16_t GetAlpha() const;
+};
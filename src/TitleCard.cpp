@@ -48,11 +48,12 @@ void TITLECARD::DrawRibbon(const RECT *rect, int x, int y, int width)
 	gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, &rect[2], LEVEL_RENDERLAYER_TITLECARD, x, y, false, false);
 }
 
-//General titlecard function
-void TITLECARD::UpdateAndDraw()
+//General titlecard functions
+void TITLECARD::Update()
 {
 	//Don't update or draw if ended
-	if (frame >= TT_END)
+	visible = (frame < TT_END);
+	if (!visible)
 		return;
 	
 	//Update lines
@@ -63,6 +64,25 @@ void TITLECARD::UpdateAndDraw()
 		line[i].xsp = mmin(mmax(line[i].xsp, line[i].xMin), line[i].xMax); line[i].ysp = mmin(mmax(line[i].ysp, line[i].yMin), line[i].yMax);
 	}
 	
+	//Speed lines up when ending
+	if (frame == TT_SHOWEND)
+	{
+		for (size_t i = 0; i < LINE_MAX; i++)
+			line[i].xAcc = line[i].xAcc * -7;
+	}
+	
+	//Remember the frame we're to be drawn at, then increment frame and check for unlock
+	drawFrame = frame;
+	if (++frame >= TT_UNLOCK)
+		activeLock = false;
+}
+
+void TITLECARD::Draw()
+{
+	//Don't draw if ended
+	if (!visible)
+		return;
+	
 	//Draw CuckySonic label
 	const RECT cuckyLabel = {0, 0, 96, 16};
 	const RECT cuckyRibbon[3] = {
@@ -100,28 +120,21 @@ void TITLECARD::UpdateAndDraw()
 	subtitleFont->DrawString(subtitle, LEVEL_RENDERLAYER_TITLECARD, line[LINE_LEVEL_SUBTITLE].x / 0x100 + 4, line[LINE_LEVEL_SUBTITLE].y / 0x100 - 5);
 	DrawRibbon(subtitleRibbon, line[LINE_LEVEL_SUBTITLE].x / 0x100, line[LINE_LEVEL_SUBTITLE].y / 0x100, subtitle.length() - 1);
 	
-	//Speed lines up when ending
-	if (frame == TT_SHOWEND)
-	{
-		for (size_t i = 0; i < LINE_MAX; i++)
-			line[i].xAcc = line[i].xAcc * -7;
-	}
-	
 	//Get our background position
 	int backX = -focusX;
 	int backY = -focusY;
 	int openRadius = 0;
 	
-	if (frame < TT_SHOWEND)
+	if (drawFrame < TT_SHOWEND)
 	{
 		//Scroll to target position
-		backX += (TT_SHOWEND - frame);
-		backY += (TT_SHOWEND - frame);
+		backX += (TT_SHOWEND - drawFrame);
+		backY += (TT_SHOWEND - drawFrame);
 	}
 	else
 	{
 		//Open up around target position
-		openRadius += (frame - TT_SHOWEND);
+		openRadius += (drawFrame - TT_SHOWEND);
 	}
 	
 	//Draw background
@@ -162,9 +175,4 @@ void TITLECARD::UpdateAndDraw()
 			gSoftwareBuffer->DrawTexture(texture, texture->loadedPalette, rc, LEVEL_RENDERLAYER_TITLECARD, x, y, false, false);
 		}
 	}
-
-	//Increment frame and check for unlock
-	if (++frame >= TT_UNLOCK)
-		activeLock = false;
-	return;
 }
@@ -24,6 +24,9 @@ class TITLECARD
 		bool activeLock = true;
 		unsigned int frame = 0;
 		
+		bool visible = false;			//If we were updated before ending (and should be drawn)
+		unsigned int drawFrame = 0;		//The frame we were last updated on
+		
 		//Text
 		std::string name;
 		std::string subtitle;
@@ -48,5 +51,6 @@ class TITLECARD
 		TITLECARD(std::string levelName, std::string levelSubtitle);
 		~TITLECARD();
 		void DrawRibbon(const RECT *rect, int x, int y, int width);
-		void UpdateAndDraw();
+		void Update();
+		void Draw();
 };
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "WorkerPool.h"
+
+//Constructor and destructor
+WORKERPOOL::WORKERPOOL(size_t setThreads)
+{
+	//Start our threads (the calling thread also works on each batch, so we need one less)
+	for (size_t i = 1; i < setThreads; i++)
+		threads.emplace_back(&WORKERPOOL::Worker, this);
+}
+
+WORKERPOOL::~WORKERPOOL()
+{
+	//Tell our threads to quit and wait for them
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	startCondition.notify_all();
+	
+	for (size_t i = 0; i < threads.size(); i++)
+		threads[i].join();
+}
+
+//Job functions
+size_t WORKERPOOL::RunJobs(WORKERPOOL_FUNCTION runFunction, void *runData, size_t runJobs)
+{
+	//Take jobs until there are none left
+	size_t ran = 0;
+	for (size_t job; (job = nextJob.fetch_add(1)) < runJobs; ran++)
+		runFunction(runData, job);
+	return ran;
+}
+
+void WORKERPOOL::Run(WORKERPOOL_FUNCTION setFunction, void *setData, size_t setJobs)
+{
+	//Without any threads, or with only one job, just run everything here
+	if (threads.empty() || setJobs <= 1)
+	{
+		for (size_t i = 0; i < setJobs; i++)
+			setFunction(setData, i);
+		return;
+	}
+	
+	//Start our batch
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		function = setFunction;
+		data = setData;
+		jobs = setJobs;
+		nextJob = 0;
+		finishedJobs = 0;
+		batch++;
+	}
+	startCondition.notify_all();
+	
+	//Work on the batch ourselves, then wait for the rest of it to finish
+	size_t ran = RunJobs(setFunction, setData, setJobs);
+	
+	std::unique_lock<std::mutex> lock(mutex);
+	finishedJobs += ran;
+	finishCondition.wait(lock, [this] { return finishedJobs >= jobs && activeWorkers == 0; });
+}
+
+void WORKERPOOL::Worker()
+{
+	unsigned int lastBatch = 0;
+	
+	while (1)
+	{
+		//Wait for a new batch (or to quit), and take our own copy of it
+		WORKERPOOL_FUNCTION runFunction;
+		void *runData;
+		size_t runJobs;
+		
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [this, lastBatch] { return quit || batch != lastBatch; });
+			if (quit)
+				return;
+			lastBatch = batch;
+			
+			//If we woke up too late and the batch has already finished, Run may be about to start the next one, so leave it alone
+			if (finishedJobs >= jobs)
+				continue;
+			
+			runFunction = function;
+			runData = data;
+			runJobs = jobs;
+			activeWorkers++;
+		}
+		
+		//Work on the batch, then report how many jobs we finished
+		size_t ran = RunJobs(runFunction, runData, runJobs);
+		
+		bool finished;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finishedJobs += ran;
+			finished = (--activeWorkers == 0) && finishedJobs >= jobs;
+		}
+		
+		if (finished)
+			finishCondition.notify_one();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Worker pool job function (called once for each job index)
+typedef void (*WORKERPOOL_FUNCTION)(void *data, size_t job);
+
+//Worker pool class (persistent threads that split a batch of jobs with the calling thread)
+class WORKERPOOL
+{
+	private:
+		//Our threads
+		std::vector<std::thread> threads;
+		
+		//Current batch
+		std::mutex mutex;
+		std::condition_variable startCondition, finishCondition;
+		
+		WORKERPOOL_FUNCTION function = nullptr;
+		void *data = nullptr;
+		size_t jobs = 0;
+		
+		std::atomic<size_t> nextJob{0};
+		size_t finishedJobs = 0;
+		size_t activeWorkers = 0;	//Workers that have picked up the current batch and haven't reported back yet
+		
+		unsigned int batch = 0;	//Incremented for every batch, so workers know when there's new work
+		bool quit = false;
+	
+	public:
+		//Constructor and destructor
+		WORKERPOOL(size_t setThreads);
+		~WORKERPOOL();
+		
+		//Run the given function for jobs [0, setJobs) and wait for all of them to finish
+		void Run(WORKERPOOL_FUNCTION setFunction, void *setData, size_t setJobs);
+		
+		//Get how many threads will work on a batch (including the calling thread)
+		inline size_t GetThreads() { return threads.size() + 1; }
+	
+	private:
+		void Worker();
+		size_t RunJobs(WORKERPOOL_FUNCTION runFunction, void *runData, size_t runJobs);
+};